@@ -3,43 +3,143 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <stdarg.h>
 #include "cmsis_os2.h"
+#include "cmsis_compiler.h"  // __DMB only; the device header would clash with TivaWare
+#include "rtx_os.h"
 #include "inc/hw_memmap.h"
+#include "inc/hw_uart.h"
 #include "driverlib/sysctl.h"
 #include "driverlib/gpio.h"
 #include "driverlib/uart.h"
 #include "driverlib/pin_map.h"
 #include "driverlib/interrupt.h"
 #include "driverlib/timer.h"
+#include "driverlib/udma.h"
 
 #define MAX_N 100
 
+#define UART_DMA_BUF_SIZE 512           // Room for a full MAX_N array line
+#define UART_DMA_FLAG_DONE 0x0100   // Thread flag set when a submitted buffer is in the TX FIFO (buffer reusable)
+
+#define UART_DMA_FREE 0
+#define UART_DMA_FILLING 1
+#define UART_DMA_QUEUED 2
+
+#define UART_RX_FIFO_LEVEL UART_FIFO_RX4_8   // RX interrupt at 8 of 16 bytes, RT covers the tail
+#define UART_RX_RING_SIZE 128                // Must be a power of 2
+
+#define INPUT_FLAG_LINE 0x0001        // A complete line is waiting in uartRxQueue
+#define INPUT_FLAG_SORT_DONE 0x0002   // One of the sort threads finished
+
+// Lock-free single-producer/single-consumer byte queue. head is only written
+// by the producer and tail only by the consumer, so an ISR can feed a thread
+// without locks or disabling interrupts. Capacity must be a power of 2.
+typedef struct {
+    volatile uint32_t head;
+    volatile uint32_t tail;
+    uint32_t mask;
+    volatile uint8_t *data;
+} SpscQueue;
+
+#define SPSC_QUEUE_INIT(buf) { 0, 0, sizeof(buf) - 1, (buf) }
+
+static inline bool spscPut(SpscQueue *q, uint8_t c) {
+    uint32_t head = q->head;
+    if (head - q->tail > q->mask) return false;
+    q->data[head & q->mask] = c;
+    __DMB();   // Byte must be visible before the consumer sees the new head
+    q->head = head + 1;
+    return true;
+}
+
+static inline bool spscGet(SpscQueue *q, uint8_t *c) {
+    uint32_t tail = q->tail;
+    if (tail == q->head) return false;
+    __DMB();
+    *c = q->data[tail & q->mask];
+    __DMB();   // Finish reading before the slot is handed back to the producer
+    q->tail = tail + 1;
+    return true;
+}
+
+// Consumer side only: drops everything queued so far
+static inline void spscFlush(SpscQueue *q) {
+    q->tail = q->head;
+}
+
 typedef struct {
     uint32_t N;
     int data[MAX_N];
 } SortData;
 
+#define LOG_QUEUE_LEN 32
+#define LOG_POOL_BLOCKS 8
+#define LOGGER_STACK_SIZE 1024
+
+typedef enum {
+    LOG_PROMPT = 0,
+    LOG_INVALID_N,
+    LOG_RANDOM,
+    LOG_ARRAY,
+    LOG_FINAL
+} LogFormatId;
+
+typedef struct {
+    uint32_t tick;        // osKernelGetTickCount() when the record was posted
+    uint8_t fmt;          // LogFormatId
+    const char *algo;     // Static string, never copied
+    uint32_t arg;         // MAX_N for LOG_INVALID_N, duration for LOG_FINAL
+    int *values;          // Array snapshot from logPool, or NULL
+    uint32_t count;
+} LogRecord;
+
 osMessageQueueId_t queueBubble;
 osMessageQueueId_t queueInsert;
 osMessageQueueId_t queueQuick;
-osMutexId_t uartMutex;
+osMessageQueueId_t logQueue;
+osMemoryPoolId_t logPool;
+
+// Logger storage is static so it does not eat into the RTX dynamic memory
+uint64_t loggerStack[LOGGER_STACK_SIZE / 8];
+uint32_t logQueueMem[osRtxMessageQueueMemSize(LOG_QUEUE_LEN, sizeof(LogRecord)) / 4];
+uint32_t logPoolMem[osRtxMemoryPoolMemSize(LOG_POOL_BLOCKS, sizeof(int) * MAX_N) / 4];
 
 uint32_t SysClock;
 char inputBuffer[100];
 int bufferIndex = 0;
-volatile bool inputReady = false;
+
+// Filled by UARTIntHandler, drained by Thread_Input
+volatile uint8_t uartRxStorage[UART_RX_RING_SIZE];
+SpscQueue uartRxQueue = SPSC_QUEUE_INIT(uartRxStorage);
+osThreadId_t inputThread = NULL;
+volatile uint32_t uartRxInterrupts = 0;   // RX + RT interrupts taken
+volatile uint32_t uartRxBytes = 0;        // Bytes read from the FIFO
+volatile uint32_t uartRxOverruns = 0;     // Hardware FIFO overruns
+volatile uint32_t uartRxDropped = 0;      // Bytes lost because the ring was full
 
 volatile bool bubbleDone = true;
 volatile bool insertionDone = true;
 volatile bool quickDone = true;
 
+// uDMA control table must be 1024-byte aligned
+uint8_t dmaControlTable[1024] __attribute__((aligned(1024)));
+
+// Two transmit buffers: one is formatted while the other is on the wire
+char uartDmaBuf[2][UART_DMA_BUF_SIZE];
+volatile uint8_t uartDmaState[2] = { UART_DMA_FREE, UART_DMA_FREE };
+uint32_t uartDmaLen[2];
+osThreadId_t uartDmaNotify[2];
+volatile int uartDmaActive = -1;
+volatile int uartDmaPending = -1;
+osSemaphoreId_t uartDmaFree;
+
 void SetupUart(void) {
     SysCtlPeripheralEnable(SYSCTL_PERIPH_UART0);
     while (!SysCtlPeripheralReady(SYSCTL_PERIPH_UART0));
     UARTConfigSetExpClk(UART0_BASE, SysClock, 115200,
                         (UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE));
-    UARTFIFODisable(UART0_BASE);
+    UARTFIFOEnable(UART0_BASE);
+    UARTFIFOLevelSet(UART0_BASE, UART_FIFO_TX4_8, UART_RX_FIFO_LEVEL);
     SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOA);
     while (!SysCtlPeripheralReady(SYSCTL_PERIPH_GPIOA));
     GPIOPinConfigure(GPIO_PA0_U0RX);
@@ -47,22 +147,122 @@ void SetupUart(void) {
     GPIOPinTypeUART(GPIO_PORTA_BASE, GPIO_PIN_0 | GPIO_PIN_1);
 }
 
+void SetupUartDma(void) {
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_UDMA);
+    while (!SysCtlPeripheralReady(SYSCTL_PERIPH_UDMA));
+    uDMAEnable();
+    uDMAControlBaseSet(dmaControlTable);
+
+    uDMAChannelAssign(UDMA_CH9_UART0TX);
+    uDMAChannelAttributeDisable(UDMA_CH9_UART0TX, UDMA_ATTR_ALL);
+    uDMAChannelControlSet(UDMA_CH9_UART0TX | UDMA_PRI_SELECT,
+                          UDMA_SIZE_8 | UDMA_SRC_INC_8 | UDMA_DST_INC_NONE | UDMA_ARB_4);
+
+    uartDmaFree = osSemaphoreNew(2, 2, NULL);
+    UARTDMAEnable(UART0_BASE, UART_DMA_TX);
+}
+
+static void UARTDmaStart(int idx) {
+    uartDmaActive = idx;
+    uDMAChannelTransferSet(UDMA_CH9_UART0TX | UDMA_PRI_SELECT, UDMA_MODE_BASIC,
+                           uartDmaBuf[idx], (void *)(UART0_BASE + UART_O_DR), uartDmaLen[idx]);
+    uDMAChannelEnable(UDMA_CH9_UART0TX);
+}
+
+// Called from the UART ISR when the active buffer has been handed to the FIFO
+static void UARTDmaComplete(void) {
+    int done = uartDmaActive;
+    if (done < 0) return;
+
+    osThreadId_t notify = uartDmaNotify[done];
+    uartDmaState[done] = UART_DMA_FREE;
+    osSemaphoreRelease(uartDmaFree);
+    if (notify != NULL) {
+        osThreadFlagsSet(notify, UART_DMA_FLAG_DONE);
+    }
+
+    if (uartDmaPending >= 0) {
+        int next = uartDmaPending;
+        uartDmaPending = -1;
+        UARTDmaStart(next);
+    } else {
+        uartDmaActive = -1;
+    }
+}
+
+// Blocks until one of the two buffers is free. Only Thread_Logger transmits,
+// so buffers are submitted in the same order they were acquired.
+char *UARTDmaAcquire(void) {
+    osSemaphoreAcquire(uartDmaFree, osWaitForever);
+    int idx = (uartDmaState[0] == UART_DMA_FREE) ? 0 : 1;
+    uartDmaState[idx] = UART_DMA_FILLING;
+    return uartDmaBuf[idx];
+}
+
+// Queues a buffer from UARTDmaAcquire for transmission and returns at once.
+// If notify is not NULL that thread gets UART_DMA_FLAG_DONE once the uDMA has
+// moved the whole buffer into the UART FIFO. The last bytes may still be
+// shifting out then; use UARTDmaDrain when they must be on the wire.
+void UARTDmaSubmit(char *buf, uint32_t len, osThreadId_t notify) {
+    int idx = (buf == uartDmaBuf[0]) ? 0 : 1;
+
+    if (len == 0) {
+        uartDmaState[idx] = UART_DMA_FREE;
+        osSemaphoreRelease(uartDmaFree);
+        return;
+    }
+    uartDmaLen[idx] = len;
+    uartDmaNotify[idx] = notify;
+    uartDmaState[idx] = UART_DMA_QUEUED;
+
+    UARTIntDisable(UART0_BASE, UART_INT_DMATX);
+    if (uartDmaActive < 0) {
+        UARTDmaStart(idx);
+    } else {
+        uartDmaPending = idx;
+    }
+    UARTIntEnable(UART0_BASE, UART_INT_DMATX);
+}
+
+// Blocks until nothing is queued or active and the UART has shifted out the
+// last stop bit. Call before anything that needs the line idle, such as a
+// baud change or entering a low-power mode.
+void UARTDmaDrain(void) {
+    while (uartDmaActive >= 0 || UARTBusy(UART0_BASE)) {
+        osDelay(1);
+    }
+}
+
 void UARTIntHandler(void) {
     uint32_t status = UARTIntStatus(UART0_BASE, true);
     UARTIntClear(UART0_BASE, status);
-    char receivedChar;
 
+    if ((status & UART_INT_DMATX) && !uDMAChannelIsEnabled(UDMA_CH9_UART0TX)) {
+        UARTDmaComplete();
+    }
+    if (status & UART_INT_OE) {
+        uartRxOverruns++;
+    }
+    if (status & (UART_INT_RX | UART_INT_RT)) {
+        uartRxInterrupts++;
+    }
+
+    // Drain the whole FIFO per interrupt; Thread_Input is only woken when a
+    // line is complete. Echo never waits: it is skipped if the TX FIFO is full.
+    bool lineDone = false;
     while (UARTCharsAvail(UART0_BASE)) {
-        receivedChar = (char)UARTCharGet(UART0_BASE);
-        UARTCharPut(UART0_BASE, receivedChar);
-        if (receivedChar == '\r' || receivedChar == '\n') {
-            inputBuffer[bufferIndex] = '\0';
-            bufferIndex = 0;
-            inputReady = true;
-        } else if (bufferIndex < sizeof(inputBuffer) - 1) {
-            inputBuffer[bufferIndex++] = receivedChar;
+        uint8_t c = (uint8_t)UARTCharGetNonBlocking(UART0_BASE);
+        uartRxBytes++;
+        UARTCharPutNonBlocking(UART0_BASE, c);
+        if (!spscPut(&uartRxQueue, c)) {
+            uartRxDropped++;
+        } else if (c == '\r' || c == '\n') {
+            lineDone = true;
         }
     }
+    if (lineDone && inputThread != NULL) {
+        osThreadFlagsSet(inputThread, INPUT_FLAG_LINE);
+    }
 }
 
 void SetupTimer(void) {
@@ -83,43 +283,121 @@ uint32_t stop_us(void) {
     return (uint32_t)(((uint64_t)elapsed * 1000000) / SysClock);
 }
 
-void logMessage(const char *fmt, ...) {
-    osMutexAcquire(uartMutex, osWaitForever);
-    char logBuf[256];
-    va_list args;
-    va_start(args, fmt);
-    vsnprintf(logBuf, sizeof(logBuf), fmt, args);
-    va_end(args);
-    for (char *p = logBuf; *p; p++) {
-        UARTCharPut(UART0_BASE, *p);
+// --- Deferred logger ---
+// Producers only post a LogRecord (timestamp, format id, arguments) and never
+// block; Thread_Logger formats and transmits them at low priority. Arrays are
+// snapshotted into logPool so the sort can keep running on its own copy.
+
+// Records the producer posted while the queue or pool was full
+volatile uint32_t logDropped = 0;
+
+static void logPost(uint8_t fmt, const char *algo, uint32_t arg, const int *values, uint32_t count) {
+    LogRecord rec = { .tick = osKernelGetTickCount(), .fmt = fmt, .algo = algo,
+                      .arg = arg, .values = NULL, .count = 0 };
+
+    if (values != NULL && count > 0) {
+        rec.values = osMemoryPoolAlloc(logPool, 0);
+        if (rec.values == NULL) {
+            logDropped++;
+            return;
+        }
+        memcpy(rec.values, values, count * sizeof(int));
+        rec.count = count;
+    }
+    if (osMessageQueuePut(logQueue, &rec, 0, 0) != osOK) {
+        if (rec.values != NULL) {
+            osMemoryPoolFree(logPool, rec.values);
+        }
+        logDropped++;
+    }
+}
+
+static int logAppendValues(char *buf, int pos, const int *values, uint32_t count) {
+    for (uint32_t i = 0; i < count && pos < UART_DMA_BUF_SIZE; i++) {
+        pos += snprintf(buf + pos, UART_DMA_BUF_SIZE - pos, "%d ", values[i]);
     }
-    osMutexRelease(uartMutex);
+    return pos;
+}
+
+void Thread_Logger(void *argument) {
+    LogRecord rec;
+    uint32_t reportedDrops = 0;
+
+    while (1) {
+        osMessageQueueGet(logQueue, &rec, NULL, osWaitForever);
+
+        char *buf = UARTDmaAcquire();
+        int pos = 0;
+        switch (rec.fmt) {
+            case LOG_PROMPT:
+                pos = snprintf(buf, UART_DMA_BUF_SIZE, "\r\nEnter N: ");
+                break;
+            case LOG_INVALID_N:
+                pos = snprintf(buf, UART_DMA_BUF_SIZE, "Invalid N! Max %lu.\r\n", rec.arg);
+                break;
+            case LOG_RANDOM:
+                pos = snprintf(buf, UART_DMA_BUF_SIZE, "\r\nRandom numbers: ");
+                pos = logAppendValues(buf, pos, rec.values, rec.count);
+                if (pos < UART_DMA_BUF_SIZE) {
+                    pos += snprintf(buf + pos, UART_DMA_BUF_SIZE - pos, "\r\n");
+                }
+                break;
+            case LOG_ARRAY:
+                pos = snprintf(buf, UART_DMA_BUF_SIZE, "Tick %lu [%s]: ", rec.tick, rec.algo);
+                pos = logAppendValues(buf, pos, rec.values, rec.count);
+                if (pos < UART_DMA_BUF_SIZE) {
+                    pos += snprintf(buf + pos, UART_DMA_BUF_SIZE - pos, "\r\n");
+                }
+                break;
+            case LOG_FINAL:
+                pos = snprintf(buf, UART_DMA_BUF_SIZE, "Tick %lu [%s]: Final Sorted: ", rec.tick, rec.algo);
+                pos = logAppendValues(buf, pos, rec.values, rec.count);
+                if (pos < UART_DMA_BUF_SIZE) {
+                    pos += snprintf(buf + pos, UART_DMA_BUF_SIZE - pos, "| Time: %lu us\r\n", rec.arg);
+                }
+                break;
+        }
+        if (rec.values != NULL) {
+            osMemoryPoolFree(logPool, rec.values);
+        }
+
+        uint32_t drops = logDropped;
+        if (drops != reportedDrops && pos < UART_DMA_BUF_SIZE) {
+            snprintf(buf + pos, UART_DMA_BUF_SIZE - pos, "[log] %lu records dropped\r\n", drops - reportedDrops);
+            reportedDrops = drops;
+        }
+        UARTDmaSubmit(buf, strlen(buf), NULL);
+    }
+}
+
+// Consumes received bytes into inputBuffer.
+// Returns true once a full line is available.
+bool UARTReadLine(void) {
+    uint8_t c;
+
+    while (spscGet(&uartRxQueue, &c)) {
+        char receivedChar = (char)c;
+        if (receivedChar == '\r' || receivedChar == '\n') {
+            inputBuffer[bufferIndex] = '\0';
+            bufferIndex = 0;
+            return true;
+        } else if (bufferIndex < sizeof(inputBuffer) - 1) {
+            inputBuffer[bufferIndex++] = receivedChar;
+        }
+    }
+    return false;
 }
 
 void prompt() {
-    logMessage("\r\nEnter N: ");
+    logPost(LOG_PROMPT, NULL, 0, NULL, 0);
 }
 
 void printArray(const char* algo, int arr[], uint32_t N) {
-    char buf[256];
-    int pos = snprintf(buf, sizeof(buf), "Tick %lu [%s]: ", osKernelGetTickCount(), algo);
-    for (uint32_t i = 0; i < N; i++) {
-        pos += snprintf(buf + pos, sizeof(buf) - pos, "%d ", arr[i]);
-        if (pos >= sizeof(buf)) break;
-    }
-    snprintf(buf + pos, sizeof(buf) - pos, "\r\n");
-    logMessage("%s", buf);
+    logPost(LOG_ARRAY, algo, 0, arr, N);
 }
 
 void printFinalSorted(const char* algo, int arr[], uint32_t N, uint32_t duration) {
-    char buf[256];
-    int pos = snprintf(buf, sizeof(buf), "Tick %lu [%s]: Final Sorted: ", osKernelGetTickCount(), algo);
-    for (uint32_t i = 0; i < N; i++) {
-        pos += snprintf(buf + pos, sizeof(buf) - pos, "%d ", arr[i]);
-        if (pos >= sizeof(buf)) break;
-    }
-    pos += snprintf(buf + pos, sizeof(buf) - pos, "| Time: %lu us\r\n", duration);
-    logMessage("%s", buf);
+    logPost(LOG_FINAL, algo, duration, arr, N);
 }
 
 bool isSorted(int arr[], uint32_t N) {
@@ -234,6 +512,7 @@ void Thread_Sort(void *argument) {
                 *doneFlag = true;
             }
         }
+        osThreadFlagsSet(inputThread, INPUT_FLAG_SORT_DONE);
     }
 }
 
@@ -243,35 +522,33 @@ void Thread_Input(void *argument) {
 
     while (1) {
         while (!(bubbleDone && insertionDone && quickDone)) {
-            osDelay(10);
+            osThreadFlagsWait(INPUT_FLAG_SORT_DONE, osFlagsWaitAny, osWaitForever);
         }
 
         prompt();
         memset(inputBuffer, 0, sizeof(inputBuffer));
         bufferIndex = 0;
-        inputReady = false;
+        spscFlush(&uartRxQueue);   // Discard anything typed while sorting
+        osThreadFlagsClear(INPUT_FLAG_LINE);
 
-        while (!inputReady) {
-            osDelay(10);
+        while (!UARTReadLine()) {
+            osThreadFlagsWait(INPUT_FLAG_LINE, osFlagsWaitAny, osWaitForever);
         }
 
         uint32_t N = strtoul(inputBuffer, NULL, 10);
-        inputReady = false;
 
         if (N == 0 || N > MAX_N) {
-            logMessage("Invalid N! Max %d.\r\n", MAX_N);
+            logPost(LOG_INVALID_N, NULL, MAX_N, NULL, 0);
             continue;
         }
 
         SortData data;
         data.N = N;
 
-        logMessage("\r\nRandom numbers: ");
         for (uint32_t i = 0; i < N; i++) {
             data.data[i] = rand() % 1000;
-            logMessage("%d ", data.data[i]);
         }
-        logMessage("\r\n");
+        logPost(LOG_RANDOM, NULL, 0, data.data, N);
 
         bubbleDone = false;
         insertionDone = false;
@@ -295,7 +572,12 @@ int main(void) {
     queueInsert = osMessageQueueNew(10, sizeof(SortData), NULL);
     queueQuick = osMessageQueueNew(10, sizeof(SortData), NULL);
 
-    uartMutex = osMutexNew(NULL);
+    SetupUartDma();
+
+    osMessageQueueAttr_t logQueueAttr = { .name = "Log", .mq_mem = logQueueMem, .mq_size = sizeof(logQueueMem) };
+    osMemoryPoolAttr_t logPoolAttr = { .name = "LogPool", .mp_mem = logPoolMem, .mp_size = sizeof(logPoolMem) };
+    logQueue = osMessageQueueNew(LOG_QUEUE_LEN, sizeof(LogRecord), &logQueueAttr);
+    logPool = osMemoryPoolNew(LOG_POOL_BLOCKS, sizeof(int) * MAX_N, &logPoolAttr);
 
 		osThreadAttr_t bubbleAttr = { .priority = osPriorityHigh, .stack_size = 4096 };
 		osThreadAttr_t insertAttr = { .priority = osPriorityNormal, .stack_size = 4096 };
@@ -308,10 +590,14 @@ int main(void) {
 		
 		
 		
-    osThreadNew(Thread_Input, NULL, NULL);
+    inputThread = osThreadNew(Thread_Input, NULL, NULL);
+
+    osThreadAttr_t loggerAttr = { .name = "Logger", .priority = osPriorityLow,
+                                  .stack_mem = loggerStack, .stack_size = sizeof(loggerStack) };
+    osThreadNew(Thread_Logger, NULL, &loggerAttr);
 
     UARTIntRegister(UART0_BASE, UARTIntHandler);
-    UARTIntEnable(UART0_BASE, UART_INT_RX);
+    UARTIntEnable(UART0_BASE, UART_INT_RX | UART_INT_RT | UART_INT_OE | UART_INT_DMATX);
 
     osKernelStart();
 
@@ -9,6 +9,11 @@
 #include "driverlib/uart.h"
 #include "driverlib/pin_map.h"
 #include "driverlib/interrupt.h"
+#include "fmt.h"
+
+#define UART_RX_FIFO_LEVEL UART_FIFO_RX4_8   // RX interrupt at 8 of 16 bytes, RT covers the tail
+#define UART_RX_RING_SIZE 128                // Must be a power of 2
+#define UART_RX_FLAG 0x0001
 
 osMessageQueueId_t queueFibonacciRecursiveHigh;
 osMessageQueueId_t queueFibonacciRecursiveLow;
@@ -16,7 +21,7 @@ osMessageQueueId_t queueResp;
 
 typedef struct {
     uint32_t result;
-    double timeTaken;
+    uint32_t ticks;       // Kernel ticks spent, printed in seconds by Thread_UARTWrite
     char type[30];
 } ResponseData;
 
@@ -24,6 +29,16 @@ uint32_t SysClock;
 char inputBuffer[100];
 int bufferIndex = 0;
 
+// Receive ring filled by UARTIntHandler, drained by Thread_UARTRead
+volatile uint8_t uartRxRing[UART_RX_RING_SIZE];
+volatile uint32_t uartRxHead = 0;
+volatile uint32_t uartRxTail = 0;
+volatile uint32_t uartRxInterrupts = 0;   // RX + RT interrupts taken
+volatile uint32_t uartRxBytes = 0;        // Bytes read from the FIFO
+volatile uint32_t uartRxOverruns = 0;     // Hardware FIFO overruns
+volatile uint32_t uartRxDropped = 0;      // Bytes lost because the ring was full
+osThreadId_t uartReadThread = NULL;
+
 uint32_t FibonacciRecursive(uint32_t n) {
     if (n <= 1)
         return n;
@@ -34,21 +49,52 @@ uint32_t FibonacciRecursive(uint32_t n) {
 void UARTIntHandler(void) {
     uint32_t status = UARTIntStatus(UART0_BASE, true);
     UARTIntClear(UART0_BASE, status);
-    char receivedChar;
 
+    if (status & UART_INT_OE) {
+        uartRxOverruns++;
+    }
+    if (status & (UART_INT_RX | UART_INT_RT)) {
+        uartRxInterrupts++;
+    }
+
+    // Drain the whole FIFO per interrupt and wake the reader once
+    uint32_t count = 0;
     while (UARTCharsAvail(UART0_BASE)) {
-        receivedChar = (char)UARTCharGet(UART0_BASE);
-        if (receivedChar == '\r' || receivedChar == '\n') {
-            if (bufferIndex > 0) {
-                inputBuffer[bufferIndex] = '\0';
-                uint32_t num = strtoul(inputBuffer, NULL, 10);
-                osMessageQueuePut(queueFibonacciRecursiveHigh, &num, 0, 0);
-                osMessageQueuePut(queueFibonacciRecursiveLow, &num, 0, 0);
-                bufferIndex = 0;
-            }
-        } else if (receivedChar >= '0' && receivedChar <= '9') {
-            if (bufferIndex < sizeof(inputBuffer) - 1) {
-                inputBuffer[bufferIndex++] = receivedChar;
+        uint8_t c = (uint8_t)UARTCharGetNonBlocking(UART0_BASE);
+        count++;
+        if (uartRxHead - uartRxTail < UART_RX_RING_SIZE) {
+            uartRxRing[uartRxHead & (UART_RX_RING_SIZE - 1)] = c;
+            uartRxHead++;
+        } else {
+            uartRxDropped++;
+        }
+    }
+    uartRxBytes += count;
+    if (count > 0 && uartReadThread != NULL) {
+        osThreadFlagsSet(uartReadThread, UART_RX_FLAG);
+    }
+}
+
+void Thread_UARTRead(void *argument) {
+    char receivedChar;
+
+    while (true) {
+        osThreadFlagsWait(UART_RX_FLAG, osFlagsWaitAny, osWaitForever);
+        while (uartRxTail != uartRxHead) {
+            receivedChar = (char)uartRxRing[uartRxTail & (UART_RX_RING_SIZE - 1)];
+            uartRxTail++;
+            if (receivedChar == '\r' || receivedChar == '\n') {
+                if (bufferIndex > 0) {
+                    inputBuffer[bufferIndex] = '\0';
+                    uint32_t num = strtoul(inputBuffer, NULL, 10);
+                    osMessageQueuePut(queueFibonacciRecursiveHigh, &num, 0, 0);
+                    osMessageQueuePut(queueFibonacciRecursiveLow, &num, 0, 0);
+                    bufferIndex = 0;
+                }
+            } else if (receivedChar >= '0' && receivedChar <= '9') {
+                if (bufferIndex < sizeof(inputBuffer) - 1) {
+                    inputBuffer[bufferIndex++] = receivedChar;
+                }
             }
         }
     }
@@ -59,8 +105,9 @@ void SetupUart(void) {
     while (!SysCtlPeripheralReady(SYSCTL_PERIPH_UART0));
     UARTConfigSetExpClk(UART0_BASE, SysClock, 115200,
                         (UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE));
-    UARTFIFODisable(UART0_BASE);
-    UARTIntEnable(UART0_BASE, UART_INT_RX);
+    UARTFIFOEnable(UART0_BASE);
+    UARTFIFOLevelSet(UART0_BASE, UART_FIFO_TX4_8, UART_RX_FIFO_LEVEL);
+    UARTIntEnable(UART0_BASE, UART_INT_RX | UART_INT_RT | UART_INT_OE);
     UARTIntRegister(UART0_BASE, UARTIntHandler);
     SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOA);
     while (!SysCtlPeripheralReady(SYSCTL_PERIPH_GPIOA));
@@ -79,7 +126,7 @@ void Thread_FibonacciRecursiveHigh(void *argument) {
                 uint32_t start = osKernelGetTickCount();
                 result = FibonacciRecursive(num);
                 uint32_t end = osKernelGetTickCount();
-                ResponseData response = {.result = result, .timeTaken = (double)(end - start) / osKernelGetTickFreq()};
+                ResponseData response = {.result = result, .ticks = end - start};
                 snprintf(response.type, sizeof(response.type), "Fibonacci_High");
                 osMessageQueuePut(queueResp, &response, 0, osWaitForever);
             }
@@ -97,7 +144,7 @@ void Thread_FibonacciRecursiveLow(void *argument) {
                 uint32_t start = osKernelGetTickCount();
                 result = FibonacciRecursive(num);
                 uint32_t end = osKernelGetTickCount();
-                ResponseData response = {.result = result, .timeTaken = (double)(end - start) / osKernelGetTickFreq()};
+                ResponseData response = {.result = result, .ticks = end - start};
                 snprintf(response.type, sizeof(response.type), "Fibonacci_Low");
                 osMessageQueuePut(queueResp, &response, 0, osWaitForever);
             }
@@ -112,7 +159,15 @@ void Thread_UARTWrite(void *argument) {
     while (true) {
         if (osMessageQueueGet(queueResp, &response, NULL, osWaitForever) == osOK) {
             char buffer[80];
-            snprintf(buffer, sizeof(buffer), "Result = %u (%s - %.8f seconds)\r\n", response.result, response.type, response.timeTaken < 0.000001 ? response.timeTaken * 1000000 : response.timeTaken);
+            FmtBuf f;
+            fmtInit(&f, buffer, sizeof(buffer));
+            fmtStr(&f, "Result = ");
+            fmtU32(&f, response.result);
+            fmtStr(&f, " (");
+            fmtStr(&f, response.type);
+            fmtStr(&f, " - ");
+            fmtScaled(&f, response.ticks, osKernelGetTickFreq(), 8);
+            fmtStr(&f, " seconds)\r\n");
 
             for (char *p = buffer; *p; p++) {
                 UARTCharPut(UART0_BASE, *p);
@@ -142,6 +197,9 @@ int main(void) {
     }
     
     osThreadNew(Thread_UARTWrite, NULL, NULL);
+
+    osThreadAttr_t readAttr = { .name = "UART_Read", .priority = osPriorityAboveNormal };
+    uartReadThread = osThreadNew(Thread_UARTRead, NULL, &readAttr);
     osKernelStart();
 
     while (1);
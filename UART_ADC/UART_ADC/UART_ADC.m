@@ -9,9 +9,50 @@ if ~isempty(instrfind)
     delete(instrfind);
 end
 
-s = serial('COM6', 'BaudRate', 115200, 'Terminator', 'LF');
+baudInicial = 115200; % Taxa de partida do firmware
+baudAlvo = 921600;    % Taxa negociada com "BAUD" (igual a baudInicial = sem negociacao)
+
+s = serial('COM6', 'BaudRate', baudInicial, 'Terminator', 'LF', 'Timeout', 1);
 fopen(s);
 
+% Negociar o baud rate: BAUD <taxa> -> ACK <taxa>; os dois trocam;
+% SYNC -> SYNC OK <taxa>. Sem confirmacao volta para a taxa inicial
+% (o firmware tambem volta sozinho depois de 1 s).
+if baudAlvo ~= baudInicial
+    fprintf(s, sprintf('BAUD %d', baudAlvo));
+    resposta = '';
+    for tentativa = 1:50 % Descarta amostras que ainda estavam chegando
+        resposta = strtrim(strrep(fgetl(s), char(0), ''));
+        if strncmp(resposta, 'ACK', 3) || strncmp(resposta, 'ERR', 3)
+            break;
+        end
+    end
+    if strcmp(resposta, sprintf('ACK %d', baudAlvo))
+        pause(0.01); % Deixa o comando sair antes de trocar a taxa
+        s.BaudRate = baudAlvo;
+        pause(0.05);
+        confirmado = false;
+        for tentativa = 1:3
+            flushinput(s);
+            fprintf(s, [char(13), 'SYNC']); % O CR inicial descarta lixo recebido durante a troca
+            s.Timeout = 0.2;
+            resposta = strtrim(strrep(fgetl(s), char(0), ''));
+            s.Timeout = 1;
+            if strcmp(resposta, sprintf('SYNC OK %d', baudAlvo))
+                confirmado = true;
+                break;
+            end
+        end
+        if ~confirmado
+            s.BaudRate = baudInicial;
+            disp('Sem SYNC OK, voltando para a taxa inicial');
+        end
+    else
+        disp(['Firmware recusou a taxa: ', resposta]);
+    end
+    flushinput(s);
+end
+
 % Preparar a figura
 h = figure;
 hold on;
@@ -32,7 +73,10 @@ hLine = plot(nan, nan, 'b-','LineWidth',2); % Objeto de plotagem inicial sem dad
 % Loop até que a figura seja fechada
 while ishandle(h)
     if s.BytesAvailable > 0
-        data = fscanf(s, '%d'); % Ler dados da porta serial
+        data = str2double(strrep(fgetl(s), char(0), '')); % Ler dados da porta serial
+        if isnan(data)
+            continue; % Respostas de comandos nao sao amostras
+        end
         n = n + 1; % Incrementar o número da amostra
         dataValues(end + 1) = data; % Anexar novos dados
 
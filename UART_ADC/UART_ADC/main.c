@@ -10,7 +10,11 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include "inc/hw_memmap.h"
+#include "inc/hw_types.h"
+#include "inc/hw_timer.h"
 #include "driverlib/sysctl.h"
 #include "driverlib/gpio.h"
 #include "driverlib/uart.h"
@@ -18,29 +22,572 @@
 #include "driverlib/interrupt.h"
 #include "driverlib/timer.h"
 #include "driverlib/adc.h"
+#include "uart_tx.h"
+#include "fmt.h"
 
 #define ADC_SEQUENCER 3 // Usando o sequenciador 3 do ADC para uma única amostra
+#define ADC_SAMPLE_HZ 100 // Timer0 dispara as conversoes nesta taxa
+#define FMT_BENCHMARK 0 // 1 = na partida mede snprintf x fmtU32 (ciclos DWT) e envia pela UART
+
+#if FMT_BENCHMARK
+#include "dwt.h"
+#endif
 
 uint32_t SysClock;
 
+void UARTSend(const char *pui8Buffer) {
+    UARTWrite((const uint8_t *)pui8Buffer, strlen(pui8Buffer));
+}
+
+// --- Comandos de texto recebidos pela UART (uma linha por comando) ---
+#define CMD_BUFFER_SIZE 32
+
+char cmdBuffer[CMD_BUFFER_SIZE];
+uint32_t cmdIndex = 0;
+char cmdLine[CMD_BUFFER_SIZE];  // Linha completa, tratada fora da ISR
+volatile bool cmdReady = false;
+
 void UARTIntHandler(void) {
     uint32_t status = UARTIntStatus(UART0_BASE, true);
     UARTIntClear(UART0_BASE, status);
+
+    while (UARTCharsAvail(UART0_BASE)) {
+        char c = (char)UARTCharGetNonBlocking(UART0_BASE);
+        if (c == '\r' || c == '\n') {
+            // Se o comando anterior ainda nao foi tratado, o novo e descartado
+            if (cmdIndex > 0 && !cmdReady) {
+                cmdBuffer[cmdIndex] = '\0';
+                strcpy(cmdLine, cmdBuffer);
+                cmdReady = true;
+            }
+            cmdIndex = 0;
+        } else if (cmdIndex < CMD_BUFFER_SIZE - 1) {
+            cmdBuffer[cmdIndex++] = c;
+        }
+    }
+    if (status & UART_INT_TX) {
+        UARTTxPump();
+    }
+}
+
+// --- Streaming do ADC: ASCII ("%u\r\n") ou binario em quadros COBS ---
+// Quadro binario (antes do COBS): seq | n | amostras empacotadas | CRC16 (LSB primeiro)
+// Duas amostras de 12 bits ocupam 3 bytes: b0 = a0[7:0], b1 = a0[11:8] | a1[3:0] << 4,
+// b2 = a1[11:4]. Cada quadro codificado termina com 0x00.
+#define STREAM_ASCII  0
+#define STREAM_BINARY 1
+
+#define FRAME_SAMPLES 16 // Precisa ser par
+#define FRAME_PAYLOAD_SIZE (2 + (FRAME_SAMPLES / 2) * 3 + 2)
+#define FRAME_ENCODED_SIZE (FRAME_PAYLOAD_SIZE + FRAME_PAYLOAD_SIZE / 254 + 2)
+
+volatile uint8_t streamMode = STREAM_ASCII;
+volatile bool streamPaused = false; // Durante a negociacao do baud rate
+uint16_t frameSamples[FRAME_SAMPLES];
+uint32_t frameCount = 0;
+uint8_t frameSeq = 0;
+
+// CRC-16/CCITT-FALSE (polinomio 0x1021, valor inicial 0xFFFF)
+uint16_t Crc16Ccitt(const uint8_t *data, uint32_t len) {
+    uint16_t crc = 0xFFFF;
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+// Codifica src em COBS (sem o 0x00 final). Retorna o tamanho escrito em dst.
+uint32_t CobsEncode(const uint8_t *src, uint32_t len, uint8_t *dst) {
+    uint32_t out = 1;
+    uint32_t codeIndex = 0;
+    uint8_t code = 1;
+
+    for (uint32_t i = 0; i < len; i++) {
+        if (src[i] == 0) {
+            dst[codeIndex] = code;
+            codeIndex = out++;
+            code = 1;
+        } else {
+            dst[out++] = src[i];
+            code++;
+            if (code == 0xFF) {
+                dst[codeIndex] = code;
+                codeIndex = out++;
+                code = 1;
+            }
+        }
+    }
+    dst[codeIndex] = code;
+    return out;
+}
+
+static void StreamSendFrame(void) {
+    uint8_t payload[FRAME_PAYLOAD_SIZE];
+    uint8_t encoded[FRAME_ENCODED_SIZE];
+    uint32_t pos = 0;
+
+    payload[pos++] = frameSeq++;
+    payload[pos++] = FRAME_SAMPLES;
+    for (uint32_t i = 0; i < FRAME_SAMPLES; i += 2) {
+        uint16_t a0 = frameSamples[i] & 0x0FFF;
+        uint16_t a1 = frameSamples[i + 1] & 0x0FFF;
+        payload[pos++] = (uint8_t)a0;
+        payload[pos++] = (uint8_t)((a0 >> 8) | ((a1 & 0x0F) << 4));
+        payload[pos++] = (uint8_t)(a1 >> 4);
+    }
+    uint16_t crc = Crc16Ccitt(payload, pos);
+    payload[pos++] = (uint8_t)crc;
+    payload[pos++] = (uint8_t)(crc >> 8);
+
+    uint32_t len = CobsEncode(payload, pos, encoded);
+    encoded[len++] = 0x00;
+    UARTWrite(encoded, len);
+}
+
+// Envia uma amostra no modo atual (chamada a partir da ISR do ADC/timer)
+void StreamSample(uint32_t sample) {
+    if (streamPaused) {
+        return;
+    }
+    if (streamMode == STREAM_BINARY) {
+        frameSamples[frameCount++] = (uint16_t)sample;
+        if (frameCount == FRAME_SAMPLES) {
+            StreamSendFrame();
+            frameCount = 0;
+        }
+    } else {
+        char buffer[FMT_U32_MAX_DIGITS + 3];
+        FmtBuf f;
+        fmtInit(&f, buffer, sizeof(buffer));
+        fmtU32(&f, sample);
+        fmtStr(&f, "\r\n");
+        UARTWrite((const uint8_t *)buffer, f.len);
+    }
+}
+
+// Troca o modo de streaming descartando um quadro binario incompleto
+void StreamSetMode(uint8_t mode) {
+    bool wasDisabled = IntMasterDisable();
+    streamMode = mode;
+    frameCount = 0;
+    if (!wasDisabled) {
+        IntMasterEnable();
+    }
+}
+
+// --- Resumo estatistico por janela (substitui o streaming amostra a amostra) ---
+// Com "STATS <n>" cada amostra so atualiza min/max e as somas da janela; ao
+// fim de n amostras sai um registro no modo atual:
+//   ASCII:   "STAT <seq> <n> <min> <max> <media> <rms> <desvio>\r\n" (3 casas)
+//   binario: quadro COBS seq | 0 | n | min | max | media | rms | desvio | CRC16,
+//            campos u16 LSB primeiro, media/rms/desvio em escala x16
+// O 0 no lugar da contagem de amostras separa o resumo de um quadro de amostras
+// (decodificadores antigos descartam o resumo). "STATS 0" volta ao streaming.
+// Somas inteiras exatas no lugar do Welford em ponto flutuante: com amostras
+// de 12 bits e n <= 65535 nada estoura e nao ha cancelamento.
+#define STATS_WINDOW_MAX   65535
+#define STATS_SCALE_SHIFT  4
+#define STATS_PAYLOAD_SIZE (2 + 6 * 2 + 2)
+#define STATS_ENCODED_SIZE (STATS_PAYLOAD_SIZE + 2)
+
+typedef struct {
+    uint32_t n;
+    uint32_t min;
+    uint32_t max;
+    uint32_t sum;
+    uint64_t sumSq;
+} StatsWindow;
+
+volatile uint32_t statsWindow = 0; // Amostras por registro (0 = desligado)
+StatsWindow stats = { 0, 0xFFFFFFFFu, 0, 0, 0 };
+uint8_t statsSeq = 0;
+
+// Raiz quadrada inteira (truncada) bit a bit
+static uint32_t Isqrt64(uint64_t v) {
+    uint64_t result = 0;
+    uint64_t bit = (uint64_t)1 << 62;
+    while (bit > v) bit >>= 2;
+    while (bit != 0) {
+        if (v >= result + bit) {
+            v -= result + bit;
+            result = (result >> 1) + bit;
+        } else {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)result;
 }
 
-void Timer0IntHandler(void) {
-    TimerIntClear(TIMER0_BASE, TIMER_TIMA_TIMEOUT); //clear interrupcao do timer
+static void StatsReset(void) {
+    stats.n = 0;
+    stats.min = 0xFFFFFFFFu;
+    stats.max = 0;
+    stats.sum = 0;
+    stats.sumSq = 0;
+}
 
+static void PutU16(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+// Fecha a janela: media, rms e desvio padrao populacional em milesimos
+static void StatsEmit(void) {
+    uint32_t n = stats.n;
+    uint32_t mean = (uint32_t)(((uint64_t)stats.sum * 1000 + n / 2) / n);
+    uint32_t rms = Isqrt64((stats.sumSq * 1000000) / n);
+    uint64_t spread = (uint64_t)n * stats.sumSq - (uint64_t)stats.sum * stats.sum; // n^2 * var
+    uint32_t std = Isqrt64(((spread / n) * 1000000) / n);
+
+    if (streamMode == STREAM_BINARY) {
+        uint8_t payload[STATS_PAYLOAD_SIZE];
+        uint8_t encoded[STATS_ENCODED_SIZE];
+        payload[0] = statsSeq++;
+        payload[1] = 0;
+        PutU16(&payload[2], n);
+        PutU16(&payload[4], stats.min);
+        PutU16(&payload[6], stats.max);
+        PutU16(&payload[8], ((mean << STATS_SCALE_SHIFT) + 500) / 1000);
+        PutU16(&payload[10], ((rms << STATS_SCALE_SHIFT) + 500) / 1000);
+        PutU16(&payload[12], ((std << STATS_SCALE_SHIFT) + 500) / 1000);
+        PutU16(&payload[14], Crc16Ccitt(payload, STATS_PAYLOAD_SIZE - 2));
+        uint32_t len = CobsEncode(payload, STATS_PAYLOAD_SIZE, encoded);
+        encoded[len++] = 0x00;
+        UARTWrite(encoded, len);
+    } else {
+        char buffer[72];
+        FmtBuf f;
+        fmtInit(&f, buffer, sizeof(buffer));
+        fmtStr(&f, "STAT ");
+        fmtU32(&f, statsSeq++);
+        fmtChar(&f, ' ');
+        fmtU32(&f, n);
+        fmtChar(&f, ' ');
+        fmtU32(&f, stats.min);
+        fmtChar(&f, ' ');
+        fmtU32(&f, stats.max);
+        fmtChar(&f, ' ');
+        fmtFixed(&f, (int32_t)mean, 3);
+        fmtChar(&f, ' ');
+        fmtFixed(&f, (int32_t)rms, 3);
+        fmtChar(&f, ' ');
+        fmtFixed(&f, (int32_t)std, 3);
+        fmtStr(&f, "\r\n");
+        UARTWrite((const uint8_t *)buffer, f.len);
+    }
+}
+
+// Acumula uma amostra (chamada a partir da ISR do ADC)
+void StatsSample(uint32_t sample) {
+    if (sample < stats.min) stats.min = sample;
+    if (sample > stats.max) stats.max = sample;
+    stats.sum += sample;
+    stats.sumSq += (uint64_t)(sample * sample);
+    if (++stats.n < statsWindow) {
+        return;
+    }
+    if (!streamPaused) { // Janela fechada durante a troca de baud e descartada
+        StatsEmit();
+    }
+    StatsReset();
+}
+
+// Janela de 0 (desliga) ate STATS_WINDOW_MAX amostras
+static bool StatsConfigure(uint32_t window) {
+    if (window > STATS_WINDOW_MAX) {
+        return false;
+    }
+    bool wasDisabled = IntMasterDisable();
+    statsWindow = window;
+    StatsReset();
+    if (!wasDisabled) {
+        IntMasterEnable();
+    }
+    return true;
+}
+
+// --- Aquisicao com ADC0 + ADC1 no mesmo Timer0 ---
+// "DUAL SYNC": os dois ADCs convertem no mesmo gatilho do Timer0, ADC0 em AIN0
+//   e ADC1 em AIN1 (PE2), ex. tensao e corrente do cooler no mesmo instante.
+//   Cada ADC tem a sua interrupcao; o par sai de quem terminar por ultimo
+//   (DualSyncPut), sem nenhuma ISR esperando a outra.
+// "DUAL INTER": os dois convertem AIN0 e o ADC1 e disparado no meio do periodo
+//   (interrupcao de match do Timer0), dobrando a taxa do canal. O gatilho do
+//   ADC1 e por software dentro dessa ISR, entao o instante da amostra carrega
+//   a latencia da interrupcao (~12 ciclos na entrada, mais o tempo de outra
+//   ISR de mesma prioridade que esteja rodando, ex. a da UART): alguns
+//   microssegundos de jitter, contra zero no gatilho do ADC0.
+// As amostras saem intercaladas em ordem de tempo, com t em meios periodos do
+// Timer0 (1 / (2 * ADC_SAMPLE_HZ) s):
+//   ASCII:   SYNC "<t> <ain0> <ain1>\r\n", INTER "<t> <ain0>\r\n"
+//   binario: quadros normais com as amostras em ordem (a0 b0 a1 b1 ... no SYNC);
+//            o tempo vem da sequencia do quadro e da posicao nele.
+// O resumo por janela (STATS) so vale para o modo de um ADC.
+typedef enum {
+    DUAL_OFF = 0,
+    DUAL_SYNC,
+    DUAL_INTERLEAVE
+} DualMode;
+
+// Resposta ao comando "DUAL": "<modo> <pares perdidos>"
+static const char *const dualNames[] = { "DUAL OFF", "DUAL SYNC", "DUAL INTER" };
+
+volatile DualMode dualMode = DUAL_OFF;
+volatile uint32_t dualMissed = 0; // Pares incompletos descartados (SYNC)
+uint32_t dualValue[2];              // Ultimo valor de cada ADC no modo SYNC
+bool dualHave[2];                   // dualValue[i] ainda sem o par
+
+// Envia uma amostra (ou um par simultaneo) com a marca de tempo
+static void DualEmit(uint32_t t, uint32_t a, uint32_t b, bool pair) {
+    if (streamMode == STREAM_BINARY) {
+        StreamSample(a);
+        if (pair) {
+            StreamSample(b);
+        }
+        return;
+    }
+    if (streamPaused) {
+        return;
+    }
+
+    char buffer[3 * (FMT_U32_MAX_DIGITS + 1) + 2];
+    FmtBuf f;
+    fmtInit(&f, buffer, sizeof(buffer));
+    fmtU32(&f, t);
+    fmtChar(&f, ' ');
+    fmtU32(&f, a);
+    if (pair) {
+        fmtChar(&f, ' ');
+        fmtU32(&f, b);
+    }
+    fmtStr(&f, "\r\n");
+    UARTWrite((const uint8_t *)buffer, f.len);
+}
+
+// Reprograma o seq3 do ADC1 e o match do Timer0 para o modo pedido
+static void DualConfigure(DualMode mode) {
+    bool wasDisabled = IntMasterDisable();
+
+    ADCIntDisable(ADC1_BASE, ADC_SEQUENCER);
+    TimerIntDisable(TIMER0_BASE, TIMER_TIMA_MATCH);
+    ADCSequenceDisable(ADC1_BASE, ADC_SEQUENCER);
+    if (mode == DUAL_SYNC) {
+        ADCSequenceConfigure(ADC1_BASE, ADC_SEQUENCER, ADC_TRIGGER_TIMER, 0);
+        ADCSequenceStepConfigure(ADC1_BASE, ADC_SEQUENCER, 0, ADC_CTL_CH1 | ADC_CTL_IE | ADC_CTL_END);
+    } else if (mode == DUAL_INTERLEAVE) {
+        ADCSequenceConfigure(ADC1_BASE, ADC_SEQUENCER, ADC_TRIGGER_PROCESSOR, 0);
+        ADCSequenceStepConfigure(ADC1_BASE, ADC_SEQUENCER, 0, ADC_CTL_CH0 | ADC_CTL_IE | ADC_CTL_END);
+    }
+    if (mode != DUAL_OFF) {
+        ADCSequenceEnable(ADC1_BASE, ADC_SEQUENCER);
+        ADCIntClear(ADC1_BASE, ADC_SEQUENCER);
+        ADCIntEnable(ADC1_BASE, ADC_SEQUENCER);
+    }
+    if (mode == DUAL_INTERLEAVE) {
+        TimerIntClear(TIMER0_BASE, TIMER_TIMA_MATCH);
+        TimerIntEnable(TIMER0_BASE, TIMER_TIMA_MATCH);
+    }
+    dualMode = mode;
+    dualMissed = 0;
+    dualHave[0] = false;
+    dualHave[1] = false;
+    frameCount = 0; // Um quadro binario nao mistura modos
+
+    if (!wasDisabled) {
+        IntMasterEnable();
+    }
+}
+
+// Resposta a um comando: texto, "\r\n" e 0x00, assim o decodificador
+// binario do host descarta o texto e se sincroniza no proximo quadro
+static void CommandReply(const char *text, uint32_t value, bool hasValue) {
+    static const uint8_t delimiter = 0x00;
+    char buffer[40];
+    FmtBuf f;
+
+    fmtInit(&f, buffer, sizeof(buffer));
+    fmtStr(&f, text);
+    if (hasValue) {
+        fmtChar(&f, ' ');
+        fmtU32(&f, value);
+    }
+    fmtStr(&f, "\r\n");
+    UARTWrite((const uint8_t *)buffer, f.len);
+    UARTWrite(&delimiter, 1);
+}
+
+// --- Negociacao do baud rate em tempo de execucao ---
+// 1. Host envia "BAUD <taxa>"; a placa pausa o streaming, responde "ACK <taxa>"
+//    na taxa antiga, espera o TX esvaziar e troca para a nova taxa.
+// 2. Host troca tambem e envia "SYNC"; a placa confirma com "SYNC OK <taxa>"
+//    e retoma o streaming.
+// 3. Sem SYNC dentro de BAUD_SYNC_TIMEOUT_TICKS a placa volta para a taxa
+//    anterior e avisa com "BAUD FALLBACK <taxa>". O host faz o mesmo se nao
+//    receber o "SYNC OK".
+#define BAUD_DEFAULT 115200
+#define BAUD_MIN     9600
+#define BAUD_SYNC_TIMEOUT_TICKS 100 // 1 s com o Timer0 a 100 Hz
+
+typedef enum {
+    BAUD_IDLE = 0,
+    BAUD_WAIT_SYNC
+} BaudState;
+
+BaudState baudState = BAUD_IDLE;
+uint32_t uartBaud = BAUD_DEFAULT;
+uint32_t uartBaudPrevious = BAUD_DEFAULT;
+uint32_t baudDeadline = 0;
+volatile uint32_t timerTicks = 0; // Incrementado a cada amostra do ADC
+
+// Maior taxa aceita: UART0 roda do SysClock e com HSE divide por 8
+static uint32_t BaudMax(void) {
+    return SysClock / 8;
+}
+
+// Troca a taxa depois que tudo que ja foi enfileirado saiu na taxa atual
+static void UARTSetBaud(uint32_t baud) {
+    while (!UARTTxIdle());
+
+    bool wasDisabled = IntMasterDisable();
+    UARTConfigSetExpClk(UART0_BASE, SysClock, baud,
+        (UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE));
+    uartBaud = baud;
+    cmdIndex = 0; // Bytes recebidos durante a troca sao lixo
+    if (!wasDisabled) {
+        IntMasterEnable();
+    }
+}
+
+// Chamada no loop principal: desfaz a troca se o SYNC nao chegou a tempo
+void BaudPoll(void) {
+    if (baudState == BAUD_WAIT_SYNC && (int32_t)(timerTicks - baudDeadline) >= 0) {
+        UARTSetBaud(uartBaudPrevious);
+        baudState = BAUD_IDLE;
+        streamPaused = false;
+        CommandReply("BAUD FALLBACK", uartBaud, true);
+    }
+}
+
+// Trata a linha recebida pela UART (chamada no loop principal, fora da ISR).
+// Comandos: "MODE ASCII", "MODE BIN", "BAUD <taxa>", "SYNC",
+// "STATS [<n>]" (resumo a cada n amostras, 0 desliga) e
+// "DUAL [OFF|SYNC|INTER]" (ADC0 + ADC1).
+void ProcessCommand(const char *cmd) {
+    if (baudState == BAUD_WAIT_SYNC) {
+        // Ate o link ser confirmado qualquer outra linha e lixo da troca de taxa
+        if (strcmp(cmd, "SYNC") == 0) {
+            baudState = BAUD_IDLE;
+            streamPaused = false;
+            CommandReply("SYNC OK", uartBaud, true);
+        }
+        return;
+    }
+
+    if (strcmp(cmd, "MODE ASCII") == 0) {
+        StreamSetMode(STREAM_ASCII);
+        CommandReply("OK", 0, false);
+    } else if (strcmp(cmd, "MODE BIN") == 0) {
+        StreamSetMode(STREAM_BINARY);
+        CommandReply("OK", 0, false);
+    } else if (strncmp(cmd, "BAUD ", 5) == 0) {
+        uint32_t baud = strtoul(cmd + 5, NULL, 10);
+        if (baud < BAUD_MIN || baud > BaudMax()) {
+            CommandReply("ERR", 0, false);
+            return;
+        }
+        streamPaused = true;
+        CommandReply("ACK", baud, true);
+        uartBaudPrevious = uartBaud;
+        UARTSetBaud(baud);
+        baudDeadline = timerTicks + BAUD_SYNC_TIMEOUT_TICKS;
+        baudState = BAUD_WAIT_SYNC;
+    } else if (strcmp(cmd, "SYNC") == 0) {
+        // Host conferindo o link sem troca pendente
+        CommandReply("SYNC OK", uartBaud, true);
+    } else if (strcmp(cmd, "STATS") == 0) {
+        CommandReply("STATS", statsWindow, true);
+    } else if (strncmp(cmd, "STATS ", 6) == 0) {
+        uint32_t window = strtoul(cmd + 6, NULL, 10);
+        if (StatsConfigure(window)) {
+            CommandReply("STATS", statsWindow, true);
+        } else {
+            CommandReply("ERR", 0, false);
+        }
+    } else if (strcmp(cmd, "DUAL") == 0) {
+        CommandReply(dualNames[dualMode], dualMissed, true);
+    } else if (strcmp(cmd, "DUAL OFF") == 0) {
+        DualConfigure(DUAL_OFF);
+        CommandReply("OK", 0, false);
+    } else if (strcmp(cmd, "DUAL SYNC") == 0) {
+        DualConfigure(DUAL_SYNC);
+        CommandReply("OK", 0, false);
+    } else if (strcmp(cmd, "DUAL INTER") == 0) {
+        DualConfigure(DUAL_INTERLEAVE);
+        CommandReply("OK", 0, false);
+    } else {
+        CommandReply("ERR", 0, false);
+    }
+}
+
+// DUAL SYNC: guarda o valor do ADC (0 ou 1) e envia o par quando os dois
+// chegaram. As duas ISRs tem a mesma prioridade, entao nao se interrompem.
+// O t e o do gatilho atual: timerTicks ja foi incrementado pelo ADC0 quando
+// o par fecha. Se um ADC entrega de novo sem o outro, o par velho e perdido.
+static void DualSyncPut(uint32_t adc, uint32_t value) {
+    if (dualHave[adc]) {
+        dualMissed++;
+    }
+    dualValue[adc] = value;
+    dualHave[adc] = true;
+    if (dualHave[0] && dualHave[1]) {
+        dualHave[0] = false;
+        dualHave[1] = false;
+        DualEmit(2 * timerTicks, dualValue[0], dualValue[1], true);
+    }
+}
+
+// Fim da conversao disparada pelo Timer0 (nenhuma espera ativa)
+void ADC0Seq3IntHandler(void) {
     uint32_t adcValue;
-    ADCProcessorTrigger(ADC0_BASE, ADC_SEQUENCER); // inicia o processo de conversao
-    while(!ADCIntStatus(ADC0_BASE, ADC_SEQUENCER, false)); //espera a conversao finalizar
     ADCIntClear(ADC0_BASE, ADC_SEQUENCER); // clear a interrupcao do ADC
     ADCSequenceDataGet(ADC0_BASE, ADC_SEQUENCER, &adcValue); //pega o valor lido
+    timerTicks++;
+
+    if (dualMode == DUAL_SYNC) {
+        DualSyncPut(0, adcValue);
+        return;
+    }
+    if (dualMode == DUAL_INTERLEAVE) {
+        DualEmit(2 * timerTicks, adcValue, 0, false);
+        return;
+    }
+
+    if (statsWindow) {
+        StatsSample(adcValue); // so o resumo de cada janela vai para a UART
+    } else {
+        StreamSample(adcValue); // enfileira (ASCII ou binario) sem esperar a UART
+    }
+}
+
+// DUAL INTER: meio periodo depois do gatilho do ADC0 (gatilho por software,
+// com o jitter da latencia desta ISR)
+void Timer0MatchIntHandler(void) {
+    TimerIntClear(TIMER0_BASE, TIMER_TIMA_MATCH);
+    ADCProcessorTrigger(ADC1_BASE, ADC_SEQUENCER);
+}
 
-    char buffer[10];
-    int len = snprintf(buffer, sizeof(buffer), "%u\r\n", adcValue);
-    for (int i = 0; i < len; i++) {
-        UARTCharPut(UART0_BASE, buffer[i]);
+void ADC1Seq3IntHandler(void) {
+    uint32_t adcValue;
+    ADCIntClear(ADC1_BASE, ADC_SEQUENCER);
+    ADCSequenceDataGet(ADC1_BASE, ADC_SEQUENCER, &adcValue);
+    if (dualMode == DUAL_SYNC) {
+        DualSyncPut(1, adcValue);
+    } else {
+        DualEmit(2 * timerTicks + 1, adcValue, 0, false);
     }
 }
 
@@ -48,10 +595,12 @@ void Timer0IntHandler(void) {
 void SetupUart(void) {
     SysCtlPeripheralEnable(SYSCTL_PERIPH_UART0);
     while(!SysCtlPeripheralReady(SYSCTL_PERIPH_UART0));
-    UARTConfigSetExpClk(UART0_BASE, SysClock, 115200,
+    UARTConfigSetExpClk(UART0_BASE, SysClock, BAUD_DEFAULT,
         (UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE));
-    UARTFIFODisable(UART0_BASE);
-    UARTIntEnable(UART0_BASE, UART_INT_RX);
+    UARTFIFOEnable(UART0_BASE);
+    UARTFIFOLevelSet(UART0_BASE, UART_FIFO_TX2_8, UART_FIFO_RX4_8);
+    UARTTxIntModeSet(UART0_BASE, UART_TXINT_MODE_FIFO);
+    UARTIntEnable(UART0_BASE, UART_INT_RX | UART_INT_RT);
     UARTIntRegister(UART0_BASE, UARTIntHandler);
     SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOA);
     while(!SysCtlPeripheralReady(SYSCTL_PERIPH_GPIOA));
@@ -60,34 +609,110 @@ void SetupUart(void) {
     GPIOPinTypeUART(GPIO_PORTA_BASE, GPIO_PIN_0 | GPIO_PIN_1);
 }
 
+// Em modo periodico o timer so gera a interrupcao de match com o bit TAMIE
+// do GPTMTAMR ligado, e o driverlib nao tem funcao para ele (TimerConfigure
+// reescreve o TAMR inteiro). Liga apenas esse bit, depois do TimerConfigure.
+static void TimerMatchIntModeEnable(uint32_t base) {
+    HWREG(base + TIMER_O_TAMR) |= TIMER_TAMR_TAMIE;
+}
+
+// Timer0 gera o gatilho do ADC0 em hardware, entao o instante da amostra nao
+// depende da latencia de nenhuma ISR; a interrupcao de match so e usada no
+// modo DUAL INTER
 void SetupTimer(void) {
     SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER0);
     while(!SysCtlPeripheralReady(SYSCTL_PERIPH_TIMER0));
     TimerConfigure(TIMER0_BASE, TIMER_CFG_PERIODIC);
-    uint32_t timerPeriod = SysClock / 100; 
+    uint32_t timerPeriod = SysClock / ADC_SAMPLE_HZ;
     TimerLoadSet(TIMER0_BASE, TIMER_A, timerPeriod - 1);
-    TimerIntEnable(TIMER0_BASE, TIMER_TIMA_TIMEOUT);
-    TimerIntRegister(TIMER0_BASE, TIMER_A, Timer0IntHandler);
+    TimerControlTrigger(TIMER0_BASE, TIMER_A, true);
+
+    // Match no meio do periodo (contagem descendente) para o modo DUAL INTER;
+    // a interrupcao so e habilitada por DualConfigure
+    TimerMatchSet(TIMER0_BASE, TIMER_A, timerPeriod / 2);
+    TimerMatchIntModeEnable(TIMER0_BASE);
+    TimerIntRegister(TIMER0_BASE, TIMER_A, Timer0MatchIntHandler);
     TimerEnable(TIMER0_BASE, TIMER_A);
 }
 
 void SetupADC(void) {
     SysCtlPeripheralEnable(SYSCTL_PERIPH_ADC0);
     while(!SysCtlPeripheralReady(SYSCTL_PERIPH_ADC0));
-    ADCSequenceConfigure(ADC0_BASE, ADC_SEQUENCER, ADC_TRIGGER_PROCESSOR, 0);
+    ADCSequenceConfigure(ADC0_BASE, ADC_SEQUENCER, ADC_TRIGGER_TIMER, 0);
     ADCSequenceStepConfigure(ADC0_BASE, ADC_SEQUENCER, 0, ADC_CTL_CH0 | ADC_CTL_IE | ADC_CTL_END);
     ADCSequenceEnable(ADC0_BASE, ADC_SEQUENCER);
     ADCIntClear(ADC0_BASE, ADC_SEQUENCER);
+    ADCIntRegister(ADC0_BASE, ADC_SEQUENCER, ADC0Seq3IntHandler);
+    ADCIntEnable(ADC0_BASE, ADC_SEQUENCER);
+
+    // ADC1 fica parado ate um comando DUAL
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_ADC1);
+    while(!SysCtlPeripheralReady(SYSCTL_PERIPH_ADC1));
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOE);
+    while(!SysCtlPeripheralReady(SYSCTL_PERIPH_GPIOE));
+    GPIOPinTypeADC(GPIO_PORTE_BASE, GPIO_PIN_3 | GPIO_PIN_2); // PE3 = AIN0, PE2 = AIN1
+    ADCIntRegister(ADC1_BASE, ADC_SEQUENCER, ADC1Seq3IntHandler);
+}
+
+#if FMT_BENCHMARK
+// Compara o custo medio (ciclos por amostra) das duas formas de montar a linha do ADC
+void FmtBenchmark(void) {
+    static const uint32_t samples[] = { 0, 7, 512, 1023, 2048, 4095 };
+    const uint32_t rounds = 1000;
+    const uint32_t total = rounds * (sizeof(samples) / sizeof(samples[0]));
+    char buffer[FMT_U32_MAX_DIGITS + 3];
+    volatile uint32_t sink = 0;
+
+    CycleCounterInit();
+
+    uint32_t start = CycleCounterGet();
+    for (uint32_t r = 0; r < rounds; r++) {
+        for (uint32_t i = 0; i < sizeof(samples) / sizeof(samples[0]); i++) {
+            sink += snprintf(buffer, sizeof(buffer), "%u\r\n", samples[i]);
+        }
+    }
+    uint32_t cyclesPrintf = CycleCounterGet() - start;
+
+    start = CycleCounterGet();
+    for (uint32_t r = 0; r < rounds; r++) {
+        for (uint32_t i = 0; i < sizeof(samples) / sizeof(samples[0]); i++) {
+            FmtBuf f;
+            fmtInit(&f, buffer, sizeof(buffer));
+            fmtU32(&f, samples[i]);
+            fmtStr(&f, "\r\n");
+            sink += f.len;
+        }
+    }
+    uint32_t cyclesFmt = CycleCounterGet() - start;
+
+    char report[96];
+    FmtBuf f;
+    fmtInit(&f, report, sizeof(report));
+    fmtStr(&f, "snprintf: ");
+    fmtU32(&f, cyclesPrintf / total);
+    fmtStr(&f, " ciclos/amostra, fmtU32: ");
+    fmtU32(&f, cyclesFmt / total);
+    fmtStr(&f, " ciclos/amostra\r\n");
+    UARTWrite((const uint8_t *)report, f.len);
 }
+#endif
 
 int main(void) {
     SysClock = SysCtlClockFreqSet((SYSCTL_XTAL_25MHZ | SYSCTL_OSC_MAIN | SYSCTL_USE_PLL | SYSCTL_CFG_VCO_240), 120000000);
     
     SetupUart();
-    SetupTimer();
+#if FMT_BENCHMARK
+    FmtBenchmark();
+#endif
     SetupADC();
+    SetupTimer(); // Timer0 comeca a disparar o ADC ja configurado
 
     while(1) 
     {        
+        if (cmdReady) {
+            ProcessCommand(cmdLine);
+            cmdReady = false;
+        }
+        BaudPoll();
     }
 }
@@ -0,0 +1,230 @@
+/**
+ * Benchmark do caminho UART0 na Tiva C Series TM4C1294
+ *
+ * Mede, com o contador de ciclos DWT:
+ *  - vazao de TX em saturacao (buffer circular + interrupcao TX, como nos labs);
+ *  - latencia RX -> resposta: eco direto na ISR (como no RTOS2) e comando
+ *    tratado no loop principal ("PING");
+ *  - ciclos gastos na ISR da UART por byte movimentado.
+ *
+ * O script benchUART.py (raiz do repositorio) conduz os testes e calcula os
+ * percentis. Comandos (uma linha terminada em CR ou LF):
+ *  INFO        -> "BENCH <SysClock> <baud>" (tambem enviado na partida)
+ *  PING        -> "PONG <ciclos da linha recebida ate a resposta>"
+ *  ECHO        -> "ECHO ON"; cada byte recebido volta pela ISR ate chegar ESC
+ *  TX <n>      -> n bytes de padrao e "TXDONE <n> <ciclos> <ciclos na ISR>"
+ *  STATS       -> "STATS <ISRs> <ciclos ISR> <bytes RX> <bytes TX> <descartados> <maior ocupacao>"
+ *  RESET       -> zera as estatisticas
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include "inc/hw_memmap.h"
+#include "driverlib/sysctl.h"
+#include "driverlib/gpio.h"
+#include "driverlib/uart.h"
+#include "driverlib/pin_map.h"
+#include "driverlib/interrupt.h"
+#include "uart_tx.h"
+#include "fmt.h"
+#include "dwt.h"
+
+#define BENCH_BAUD          115200
+#define BENCH_RX_FIFO_LEVEL UART_FIFO_RX4_8 // RX1_8 reduz a latencia, RX4_8 reduz ISRs por byte
+#define ECHO_EXIT_CHAR      0x1B            // ESC encerra o modo eco
+
+uint32_t SysClock;
+
+// --- Estatisticas medidas com o DWT ---
+volatile uint32_t isrCount = 0;
+volatile uint32_t isrCycles = 0;   // Ciclos dentro de UARTIntHandler
+volatile uint32_t isrRxBytes = 0;  // Bytes lidos pela ISR
+volatile uint32_t isrTxBytes = 0;  // Bytes colocados no FIFO pela ISR
+
+// --- Transmissao UART0 (common/uart_tx.c) ---
+// Como UARTWrite, mas sem descartar: espera o buffer abrir espaco
+static void UARTWriteAll(const uint8_t *data, uint32_t len) {
+    while (len > 0) {
+        uint32_t space = UARTTxSpace();
+        uint32_t count = (len < space) ? len : space;
+        if (count > 0) {
+            UARTWrite(data, count);
+            data += count;
+            len -= count;
+        }
+    }
+}
+
+// --- Comandos recebidos pela UART (uma linha por comando) ---
+#define CMD_BUFFER_SIZE 32
+
+char cmdBuffer[CMD_BUFFER_SIZE];
+uint32_t cmdIndex = 0;
+char cmdLine[CMD_BUFFER_SIZE];  // Linha completa, tratada fora da ISR
+volatile bool cmdReady = false;
+volatile uint32_t cmdTimestamp; // CYCCNT quando o fim da linha chegou
+volatile bool echoMode = false;
+
+void UARTIntHandler(void) {
+    uint32_t start = CycleCounterGet();
+    uint32_t status = UARTIntStatus(UART0_BASE, true);
+    UARTIntClear(UART0_BASE, status);
+
+    while (UARTCharsAvail(UART0_BASE)) {
+        char c = (char)UARTCharGetNonBlocking(UART0_BASE);
+        isrRxBytes++;
+        if (echoMode) {
+            // Eco direto no FIFO, sem passar pelo buffer circular
+            UARTCharPutNonBlocking(UART0_BASE, c);
+            isrTxBytes++;
+            if (c == ECHO_EXIT_CHAR) {
+                echoMode = false;
+            }
+        } else if (c == '\r' || c == '\n') {
+            // Se o comando anterior ainda nao foi tratado, o novo e descartado
+            if (cmdIndex > 0 && !cmdReady) {
+                cmdBuffer[cmdIndex] = '\0';
+                strcpy(cmdLine, cmdBuffer);
+                cmdTimestamp = CycleCounterGet();
+                cmdReady = true;
+            }
+            cmdIndex = 0;
+        } else if (cmdIndex < CMD_BUFFER_SIZE - 1) {
+            cmdBuffer[cmdIndex++] = c;
+        }
+    }
+    if (status & UART_INT_TX) {
+        isrTxBytes += UARTTxPump();
+    }
+
+    isrCount++;
+    isrCycles += CycleCounterGet() - start;
+}
+
+// --- Respostas (formatadas com common/fmt.c) ---
+// Envia "<nome> v0 v1 ... vn-1\r\n"
+static void SendReply(const char *name, const uint32_t *values, uint32_t count) {
+    char buffer[96];
+    FmtBuf f;
+
+    fmtInit(&f, buffer, sizeof(buffer));
+    fmtStr(&f, name);
+    for (uint32_t i = 0; i < count; i++) {
+        fmtChar(&f, ' ');
+        fmtU32(&f, values[i]);
+    }
+    fmtStr(&f, "\r\n");
+    UARTWriteAll((const uint8_t *)buffer, f.len);
+}
+
+// --- Testes ---
+// Satura o TX com n bytes de padrao imprimivel e mede o tempo ate a linha esvaziar
+static void BenchTx(uint32_t n) {
+    static const uint8_t pattern[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    const uint32_t patternLen = sizeof(pattern) - 1;
+
+    while (!UARTTxIdle());
+    uint32_t isrStart = isrCycles;
+    uint32_t start = CycleCounterGet();
+
+    // UARTWriteAll espera espaco no buffer: UARTWrite contaria cada pedaco
+    // recusado como descartado e sujaria o STATS
+    uint32_t sent = 0;
+    while (sent < n) {
+        uint32_t chunk = n - sent;
+        if (chunk > patternLen) {
+            chunk = patternLen;
+        }
+        UARTWriteAll(pattern, chunk);
+        sent += chunk;
+    }
+    while (!UARTTxIdle());
+
+    uint32_t values[3] = { n, CycleCounterGet() - start, isrCycles - isrStart };
+    UARTWriteAll((const uint8_t *)"\r\n", 2);
+    SendReply("TXDONE", values, 3);
+}
+
+static void SendInfo(void) {
+    uint32_t values[2] = { SysClock, BENCH_BAUD };
+    SendReply("BENCH", values, 2);
+}
+
+void ProcessCommand(const char *cmd, uint32_t timestamp) {
+    if (strcmp(cmd, "INFO") == 0) {
+        SendInfo();
+    } else if (strcmp(cmd, "PING") == 0) {
+        uint32_t latency = CycleCounterGet() - timestamp;
+        SendReply("PONG", &latency, 1);
+    } else if (strcmp(cmd, "ECHO") == 0) {
+        SendReply("ECHO ON", NULL, 0);
+        while (!UARTTxIdle());
+        echoMode = true;
+    } else if (strncmp(cmd, "TX ", 3) == 0) {
+        BenchTx(strtoul(cmd + 3, NULL, 10));
+    } else if (strcmp(cmd, "STATS") == 0) {
+        uint32_t values[6] = { isrCount, isrCycles, isrRxBytes, isrTxBytes,
+                               uartTxDropped, uartTxHighWater };
+        SendReply("STATS", values, 6);
+    } else if (strcmp(cmd, "RESET") == 0) {
+        bool wasDisabled = IntMasterDisable();
+        isrCount = 0;
+        isrCycles = 0;
+        isrRxBytes = 0;
+        isrTxBytes = 0;
+        uartTxDropped = 0;
+        uartTxHighWater = 0;
+        if (!wasDisabled) {
+            IntMasterEnable();
+        }
+        SendReply("OK", NULL, 0);
+    } else {
+        SendReply("ERR", NULL, 0);
+    }
+}
+
+void SetupUart(void) {
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_UART0);
+    while(!SysCtlPeripheralReady(SYSCTL_PERIPH_UART0));
+    UARTConfigSetExpClk(UART0_BASE, SysClock, BENCH_BAUD,
+        (UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE));
+    UARTFIFOEnable(UART0_BASE);
+    UARTFIFOLevelSet(UART0_BASE, UART_FIFO_TX2_8, BENCH_RX_FIFO_LEVEL);
+    UARTTxIntModeSet(UART0_BASE, UART_TXINT_MODE_FIFO);
+    UARTIntEnable(UART0_BASE, UART_INT_RX | UART_INT_RT);
+    UARTIntRegister(UART0_BASE, UARTIntHandler);
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOA);
+    while(!SysCtlPeripheralReady(SYSCTL_PERIPH_GPIOA));
+    GPIOPinConfigure(GPIO_PA0_U0RX);
+    GPIOPinConfigure(GPIO_PA1_U0TX);
+    GPIOPinTypeUART(GPIO_PORTA_BASE, GPIO_PIN_0 | GPIO_PIN_1);
+}
+
+int main(void) {
+    SysClock = SysCtlClockFreqSet((SYSCTL_XTAL_25MHZ | SYSCTL_OSC_MAIN | SYSCTL_USE_PLL | SYSCTL_CFG_VCO_240), 120000000);
+
+    CycleCounterInit();
+    SetupUart();
+    IntMasterEnable();
+
+    // Informa o clock para o host converter ciclos em tempo
+    SendInfo();
+
+    while (1) {
+        if (cmdReady) {
+            ProcessCommand(cmdLine, cmdTimestamp);
+            cmdReady = false;
+        }
+        // Teste e WFI com as interrupcoes mascaradas: se a linha chegar entre
+        // os dois, a interrupcao fica pendente e acorda o WFI na hora (nada
+        // mais interrompe periodicamente, entao o PING ficaria parado ate o
+        // proximo byte do host). A ISR roda logo depois do IntMasterEnable.
+        IntMasterDisable();
+        if (!cmdReady) {
+            __asm(" WFI");
+        }
+        IntMasterEnable();
+    }
+}
@@ -10,6 +10,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <string.h>
 #include "inc/hw_memmap.h"
 #include "driverlib/sysctl.h"
 #include "driverlib/gpio.h"
@@ -18,28 +19,117 @@
 #include "driverlib/timer.h"
 #include "driverlib/uart.h"
 #include "driverlib/interrupt.h"
+#include "driverlib/udma.h"
+#include "driverlib/systick.h"
+#include "uart_tx.h"
+#include "fmt.h"
+#include "inc/hw_pwm.h"
 
 #define PWM_FREQUENCY 12000 // Frequencia do PWM
 
+// --- Motor de fade: tabela de duty percorrida pelo uDMA ---
+// A cada estouro do Timer0 (FADE_STEP_HZ) o uDMA copia a proxima palavra da
+// tabela direto para o registrador de comparacao do PWM (CMPB do gerador 2 =
+// M0PWM5), sem a CPU e sem interrupcao por passo. O CMPB fica em atualizacao
+// sincronizada local (PWM_GEN_MODE_NO_SYNC): o valor escrito pelo uDMA so
+// entra quando o contador do gerador passa por zero, entao nenhum pulso sai
+// cortado e nao e preciso PWMSyncUpdate. Dois descritores (primario e
+// alternativo) apontam para a mesma tabela em ping-pong; a interrupcao do
+// Timer0 so roda uma vez por ciclo do perfil, para rearmar o que terminou.
+// A tabela tem a subida e a descida de um perfil ja com correcao gama e ja no
+// formato do registrador (modo DOWN: CMP = LOAD - largura). Perfis:
+// FADE_RAMP (rampa linear no brilho percebido) e FADE_BREATH (respiracao,
+// cosseno elevado). Qualquer outra forma de FADE_STEPS pontos em Q16 serve.
+#define FADE_STEP_HZ 120 // Passos por segundo (ciclo = 2 * FADE_STEPS passos)
+#define FADE_STEPS   100 // Pontos na subida (a descida espelha)
+#define FADE_RAMP    0
+#define FADE_BREATH  1
+#define FADE_PROFILE FADE_RAMP
+
+// Telemetria opcional do duty, limitada pelo SysTick e formatada no loop
+// principal (nunca na ISR). 0 desliga.
+#define TELEMETRY_HZ 2
+
+// O SysTick so conta 24 bits (no maximo 2^24 ciclos, ~140 ms a 120 MHz) e nao
+// alcanca 1/TELEMETRY_HZ direto: ele bate a TELEMETRY_TICK_HZ e a ISR divide.
+#define SYSCLOCK_HZ        120000000
+#define SYSTICK_MAX_PERIOD (1 << 24)
+#define TELEMETRY_TICK_HZ  100
+#if TELEMETRY_HZ
+#if (SYSCLOCK_HZ / TELEMETRY_TICK_HZ) > SYSTICK_MAX_PERIOD
+#error "TELEMETRY_TICK_HZ: periodo nao cabe nos 24 bits do SysTick"
+#endif
+#if (TELEMETRY_TICK_HZ % TELEMETRY_HZ) != 0
+#error "TELEMETRY_HZ deve dividir TELEMETRY_TICK_HZ"
+#endif
+#endif
+
 uint32_t SysClock;
-volatile uint32_t g_ui32PWMDutyCycle = 0; // Var. para guardar o status do DutyCycle
-bool g_bFadeUp = true; //Controle e direcao do fade.
+
+// Brilho (0..65535) com gama 2,2 ao longo da subida
+static const uint16_t fadeShapes[2][FADE_STEPS] = {
+    [FADE_RAMP] = {
+    0, 3, 12, 30, 56, 92, 137, 193, 259, 335,
+    423, 521, 631, 753, 886, 1032, 1189, 1359, 1541, 1735,
+    1942, 2163, 2396, 2642, 2901, 3174, 3460, 3759, 4072, 4399,
+    4740, 5094, 5463, 5845, 6242, 6653, 7079, 7518, 7973, 8441,
+    8925, 9423, 9936, 10464, 11007, 11565, 12138, 12726, 13329, 13948,
+    14582, 15231, 15896, 16576, 17272, 17983, 18711, 19454, 20212, 20987,
+    21778, 22584, 23407, 24245, 25100, 25971, 26858, 27761, 28681, 29617,
+    30570, 31539, 32524, 33526, 34545, 35580, 36632, 37701, 38787, 39889,
+    41008, 42145, 43298, 44468, 45655, 46859, 48081, 49319, 50575, 51848,
+    53139, 54446, 55771, 57113, 58473, 59851, 61245, 62658, 64087, 65535
+    },
+    [FADE_BREATH] = {
+    0, 0, 0, 0, 0, 1, 2, 4, 7, 12,
+    20, 30, 43, 61, 84, 114, 150, 195, 249, 313,
+    390, 480, 584, 704, 842, 998, 1175, 1373, 1595, 1842,
+    2115, 2415, 2744, 3104, 3496, 3920, 4378, 4871, 5401, 5967,
+    6571, 7213, 7894, 8615, 9375, 10175, 11015, 11894, 12812, 13770,
+    14765, 15799, 16868, 17974, 19113, 20286, 21489, 22723, 23984, 25271,
+    26581, 27913, 29263, 30630, 32011, 33403, 34802, 36207, 37614, 39020,
+    40422, 41816, 43200, 44570, 45922, 47254, 48563, 49844, 51095, 52312,
+    53492, 54633, 55731, 56784, 57788, 58740, 59639, 60482, 61266, 61990,
+    62650, 63247, 63777, 64239, 64633, 64956, 65209, 65390, 65499, 65535
+    },
+};
+
+uint32_t fadeTable[2 * FADE_STEPS]; // Valores de CMPB: subida e descida
+volatile uint32_t fadeCycles = 0;   // Ciclos completos do perfil
+volatile bool telemetryDue = false;
+
+#if defined(ewarm)
+#pragma data_alignment=1024
+uint8_t dmaControlTable[1024];
+#else
+uint8_t dmaControlTable[1024] __attribute__((aligned(1024)));
+#endif
 
 void setupPWM(void);
 void setupTimer(void);
+void setupTelemetry(void);
 void setupUART(void);
+void setupFade(void);
 void Timer0IntHandler(void);
+void SysTickIntHandler(void);
 void UARTSend(const char *pui8Buffer);
+void TelemetrySend(void);
 
 int main(void) {
     // Configurao do clock do sistema para 120 MHz
-    SysClock = SysCtlClockFreqSet((SYSCTL_XTAL_25MHZ | SYSCTL_OSC_MAIN | SYSCTL_USE_PLL | SYSCTL_CFG_VCO_480), 120000000);
+    SysClock = SysCtlClockFreqSet((SYSCTL_XTAL_25MHZ | SYSCTL_OSC_MAIN | SYSCTL_USE_PLL | SYSCTL_CFG_VCO_480), SYSCLOCK_HZ);
     setupUART(); 
     setupPWM();      
-	  setupTimer();
+    setupFade();
+    setupTimer();
+    setupTelemetry();
 
     while (1) {
-        // Loop principal que no faz nada, todos os ajustes de PWM so gerenciados pela interrupo do timer
+        // O fade roda no uDMA; aqui so sai a telemetria, quando ligada
+        if (telemetryDue) {
+            telemetryDue = false;
+            TelemetrySend();
+        }
     }
 }
 void setupPWM(void) {
@@ -53,9 +143,10 @@ void setupPWM(void) {
 
     // Configura gerador PWM
     uint32_t pwmPeriod = (SysClock/1) / PWM_FREQUENCY;  // Adjust clock division here
-    PWMGenConfigure(PWM0_BASE, PWM_GEN_2, PWM_GEN_MODE_DOWN);
+    // NO_SYNC: LOAD/CMP atualizam na passagem por zero, sem PWMSyncUpdate
+    PWMGenConfigure(PWM0_BASE, PWM_GEN_2, PWM_GEN_MODE_DOWN | PWM_GEN_MODE_NO_SYNC);
     PWMGenPeriodSet(PWM0_BASE, PWM_GEN_2, pwmPeriod);
-    PWMPulseWidthSet(PWM0_BASE, PWM_OUT_5, g_ui32PWMDutyCycle);
+    PWMPulseWidthSet(PWM0_BASE, PWM_OUT_5, 0);
     PWMOutputState(PWM0_BASE, PWM_OUT_5_BIT, true);
     PWMGenEnable(PWM0_BASE, PWM_GEN_2);
 
@@ -64,45 +155,104 @@ void setupPWM(void) {
     UARTSend(debugBuffer);
 }
 
+// Monta a tabela do perfil no formato do CMPB e arma os dois descritores do uDMA
+void setupFade(void) {
+    uint32_t load = PWMGenPeriodGet(PWM0_BASE, PWM_GEN_2) - 1; // Valor no registrador LOAD
+
+    for (uint32_t i = 0; i < FADE_STEPS; i++) {
+        uint32_t width = (fadeShapes[FADE_PROFILE][i] * load) >> 16;
+        fadeTable[i] = load - width;                      // Subida
+        fadeTable[2 * FADE_STEPS - 1 - i] = load - width; // Descida espelhada
+    }
+
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_UDMA);
+    while(!SysCtlPeripheralReady(SYSCTL_PERIPH_UDMA));
+    uDMAEnable();
+    uDMAControlBaseSet(dmaControlTable);
+    uDMAChannelAssign(UDMA_CH18_TIMER0A);
+    uDMAChannelAttributeDisable(UDMA_CHANNEL_TMR0A, UDMA_ATTR_ALL);
+    uDMAChannelControlSet(UDMA_CHANNEL_TMR0A | UDMA_PRI_SELECT,
+                          UDMA_SIZE_32 | UDMA_SRC_INC_32 | UDMA_DST_INC_NONE | UDMA_ARB_1);
+    uDMAChannelControlSet(UDMA_CHANNEL_TMR0A | UDMA_ALT_SELECT,
+                          UDMA_SIZE_32 | UDMA_SRC_INC_32 | UDMA_DST_INC_NONE | UDMA_ARB_1);
+    uDMAChannelTransferSet(UDMA_CHANNEL_TMR0A | UDMA_PRI_SELECT, UDMA_MODE_PINGPONG,
+                           fadeTable, (void *)(PWM0_BASE + PWM_O_2_CMPB), 2 * FADE_STEPS);
+    uDMAChannelTransferSet(UDMA_CHANNEL_TMR0A | UDMA_ALT_SELECT, UDMA_MODE_PINGPONG,
+                           fadeTable, (void *)(PWM0_BASE + PWM_O_2_CMPB), 2 * FADE_STEPS);
+    uDMAChannelEnable(UDMA_CHANNEL_TMR0A);
+}
+
 void setupTimer(void) {
-    // Habilitao o Timer 0 
+    // Habilitao o Timer 0: cada estouro pede uma transferencia ao uDMA
     SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER0);
     TimerConfigure(TIMER0_BASE, TIMER_CFG_PERIODIC);
-    TimerLoadSet(TIMER0_BASE, TIMER_A, SysClock / 120);  //para 1 segundo
-    TimerIntEnable(TIMER0_BASE, TIMER_TIMA_TIMEOUT);
+    TimerLoadSet(TIMER0_BASE, TIMER_A, SysClock / FADE_STEP_HZ - 1);
+    TimerDMAEventSet(TIMER0_BASE, TIMER_DMA_TIMEOUT_A);
+    TimerIntEnable(TIMER0_BASE, TIMER_TIMA_DMA); // Fim de um ciclo do perfil
     TimerIntRegister(TIMER0_BASE, TIMER_A, Timer0IntHandler);
     TimerEnable(TIMER0_BASE, TIMER_A);
 }
 
+void setupTelemetry(void) {
+#if TELEMETRY_HZ
+    SysTickPeriodSet(SysClock / TELEMETRY_TICK_HZ);
+    SysTickIntRegister(SysTickIntHandler);
+    SysTickIntEnable();
+    SysTickEnable();
+#endif
+}
+
+// Fim de um ciclo do perfil: rearma o descritor do uDMA que parou
 void Timer0IntHandler(void) {
-    TimerIntClear(TIMER0_BASE, TIMER_TIMA_TIMEOUT); // Clear na interrupo (tira o dedo da campainha)
-
-    uint32_t maxPeriod = PWMGenPeriodGet(PWM0_BASE, PWM_GEN_2);	  
-	
-    uint32_t increment = maxPeriod / 100;  // ncremento baseado no perodo do PWM1000 = 10 s  100 = 1s
-    if (g_bFadeUp) {
-        if (g_ui32PWMDutyCycle + increment <= maxPeriod) {
-            g_ui32PWMDutyCycle += increment;
-        } else {
-            g_ui32PWMDutyCycle = maxPeriod;
-            g_bFadeUp = false;
-        }
-    } else {
-        if (g_ui32PWMDutyCycle > increment) {
-            g_ui32PWMDutyCycle -= increment;
-        } else {
-            g_ui32PWMDutyCycle = 0;
-            g_bFadeUp = true;
-        }
+    TimerIntClear(TIMER0_BASE, TIMER_TIMA_DMA); // Clear na interrupo (tira o dedo da campainha)
+
+    if (uDMAChannelModeGet(UDMA_CHANNEL_TMR0A | UDMA_PRI_SELECT) == UDMA_MODE_STOP) {
+        uDMAChannelTransferSet(UDMA_CHANNEL_TMR0A | UDMA_PRI_SELECT, UDMA_MODE_PINGPONG,
+                               fadeTable, (void *)(PWM0_BASE + PWM_O_2_CMPB), 2 * FADE_STEPS);
+        fadeCycles++;
+    }
+    if (uDMAChannelModeGet(UDMA_CHANNEL_TMR0A | UDMA_ALT_SELECT) == UDMA_MODE_STOP) {
+        uDMAChannelTransferSet(UDMA_CHANNEL_TMR0A | UDMA_ALT_SELECT, UDMA_MODE_PINGPONG,
+                               fadeTable, (void *)(PWM0_BASE + PWM_O_2_CMPB), 2 * FADE_STEPS);
+        fadeCycles++;
     }
+}
+
+// Divisor por software: um aviso a cada TELEMETRY_TICK_HZ / TELEMETRY_HZ ticks
+void SysTickIntHandler(void) {
+#if TELEMETRY_HZ
+    static uint32_t telemetryTicks = 0;
 
-    PWMPulseWidthSet(PWM0_BASE, PWM_OUT_5, g_ui32PWMDutyCycle);
+    if (++telemetryTicks == TELEMETRY_TICK_HZ / TELEMETRY_HZ) {
+        telemetryTicks = 0;
+        telemetryDue = true;
+    }
+#endif
+}
 
-    char buffer[50];
-    sprintf(buffer, "Duty Cycle: %u\r\n", g_ui32PWMDutyCycle); 
+// "Duty Cycle: <largura em ticks>\r\n", lido do proprio PWM
+void TelemetrySend(void) {
+    char buffer[32];
+    FmtBuf f;
+    fmtInit(&f, buffer, sizeof(buffer));
+    fmtStr(&f, "Duty Cycle: ");
+    fmtU32(&f, PWMPulseWidthGet(PWM0_BASE, PWM_OUT_5));
+    fmtStr(&f, "\r\n");
     UARTSend(buffer);
 }
 
+void UARTIntHandler(void) {
+    uint32_t status = UARTIntStatus(UART0_BASE, true);
+    UARTIntClear(UART0_BASE, status);
+
+    while (UARTCharsAvail(UART0_BASE)) {
+        UARTCharGetNonBlocking(UART0_BASE);
+    }
+    if (status & UART_INT_TX) {
+        UARTTxPump();
+    }
+}
+
 void setupUART(void) {
     // Configurao da UART0 em GPIOA 
     SysCtlPeripheralEnable(SYSCTL_PERIPH_UART0);
@@ -114,13 +264,15 @@ void setupUART(void) {
     // 115200, 8-N-1 
     UARTConfigSetExpClk(UART0_BASE, SysClock, 115200,
                         (UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE));
+    UARTFIFOEnable(UART0_BASE);
+    UARTFIFOLevelSet(UART0_BASE, UART_FIFO_TX2_8, UART_FIFO_RX4_8);
+    UARTTxIntModeSet(UART0_BASE, UART_TXINT_MODE_FIFO);
     UARTIntEnable(UART0_BASE, UART_INT_RX | UART_INT_RT);
+    UARTIntRegister(UART0_BASE, UARTIntHandler);
 }
 
 void UARTSend(const char *pui8Buffer)
 // Funo para enviar strings via UART
 {
-    while (*pui8Buffer) {
-        UARTCharPut(UART0_BASE, *pui8Buffer++);
-    }
+    UARTWrite((const uint8_t *)pui8Buffer, strlen(pui8Buffer));
 }
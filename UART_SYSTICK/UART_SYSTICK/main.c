@@ -15,6 +15,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 #include "inc/hw_memmap.h"
 #include "driverlib/sysctl.h"
 #include "driverlib/gpio.h"
@@ -22,6 +23,7 @@
 #include "driverlib/pin_map.h"
 #include "driverlib/interrupt.h"
 #include "driverlib/systick.h"
+#include "uart_tx.h"
 
 #define LED_PORTN GPIO_PORTN_BASE
 #define LED_PORTF GPIO_PORTF_BASE
@@ -37,12 +39,8 @@ volatile int blinkTime = 0;
 
 void UARTSendString(const char *str);
 
-// Handler UART
-void UARTIntHandler(void) { 
-    uint32_t status = UARTIntStatus(UART0_BASE, true);
-    UARTIntClear(UART0_BASE, status);
-    uint8_t last = (uint8_t)UARTCharGetNonBlocking(UART0_BASE);
-
+// Trata um caractere recebido pela UART
+static void UARTHandleChar(uint8_t last) {
     rxbuffer[0] = rxbuffer[1];
     rxbuffer[1] = rxbuffer[2];
     rxbuffer[2] = last;
@@ -54,6 +52,20 @@ void UARTIntHandler(void) {
         GPIOPinWrite(LED_PORTF, LED_PIN_4, LED_PIN_4);
     }
 }
+
+// Handler UART
+void UARTIntHandler(void) { 
+    uint32_t status = UARTIntStatus(UART0_BASE, true);
+    UARTIntClear(UART0_BASE, status);
+
+    // Com o FIFO ligado podem chegar varios caracteres por interrupcao
+    while (UARTCharsAvail(UART0_BASE)) {
+        UARTHandleChar((uint8_t)UARTCharGetNonBlocking(UART0_BASE));
+    }
+    if (status & UART_INT_TX) {
+        UARTTxPump();
+    }
+}
 // Handler SysTick
 void SysTickIntHandler(void) {
     SysTicks1ms++;
@@ -62,10 +74,7 @@ void SysTickIntHandler(void) {
         GPIOPinWrite(LED_PORTF, LED_PIN_4, 0);
         blinkTime = 0;
         
-        UARTCharPut(UART0_BASE, 'O');
-        UARTCharPut(UART0_BASE, 'K');
-        UARTCharPut(UART0_BASE, '\r');
-        UARTCharPut(UART0_BASE, '\n');
+        UARTSendString("OK\r\n");
         UARTSendString("Teste completo\r\n");
     }
 }
@@ -81,8 +90,10 @@ void SetupUart(void) {
     SysCtlPeripheralEnable(SYSCTL_PERIPH_UART0);
     while(!SysCtlPeripheralReady(SYSCTL_PERIPH_UART0));
     UARTConfigSetExpClk(UART0_BASE, SysClock, 115200,(UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE));
-    UARTFIFODisable(UART0_BASE);
-    UARTIntEnable(UART0_BASE, UART_INT_RX);
+    UARTFIFOEnable(UART0_BASE);
+    UARTFIFOLevelSet(UART0_BASE, UART_FIFO_TX2_8, UART_FIFO_RX1_8);
+    UARTTxIntModeSet(UART0_BASE, UART_TXINT_MODE_FIFO);
+    UARTIntEnable(UART0_BASE, UART_INT_RX | UART_INT_RT);
     UARTIntRegister(UART0_BASE, UARTIntHandler);
     SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOA);
     while(!SysCtlPeripheralReady(SYSCTL_PERIPH_GPIOA));
@@ -100,9 +111,7 @@ void ConfigLEDs(void) {
 
 // String
 void UARTSendString(const char *str) {
-    while (*str != '\0') { 
-        UARTCharPut(UART0_BASE, *str++);
-    }
+    UARTWrite((const uint8_t *)str, strlen(str));
 }
 
 int main(void) {
@@ -0,0 +1,186 @@
+"""Conduz o firmware UART_BENCH e mede o caminho UART0.
+
+Exemplo:
+    python benchUART.py COM8 --salvar base.json
+    python benchUART.py COM8 --comparar base.json
+
+Testes: latência PING (comando tratado no loop principal), latência do eco
+na ISR, vazão de TX em saturação e ciclos de ISR por byte.
+
+O firmware usa baud fixo (BENCH_BAUD, 115200): --baud so serve se o firmware
+for recompilado com o mesmo valor.
+"""
+import argparse
+import json
+import time
+
+import serial
+
+ESC = b'\x1b'
+
+
+# --- ESTATÍSTICAS ---
+def percentil(valores, p):
+    ordenados = sorted(valores)
+    indice = min(len(ordenados) - 1, int(round(p / 100 * (len(ordenados) - 1))))
+    return ordenados[indice]
+
+def resumo(valores):
+    return {
+        'p50': percentil(valores, 50),
+        'p90': percentil(valores, 90),
+        'p99': percentil(valores, 99),
+        'max': max(valores),
+    }
+
+def imprimir_resumo(nome, r, unidade):
+    print(f'{nome:28s} p50 {r["p50"]:9.1f}  p90 {r["p90"]:9.1f}  '
+          f'p99 {r["p99"]:9.1f}  max {r["max"]:9.1f} {unidade}')
+
+
+# --- COMUNICAÇÃO ---
+def ler_linha(ser, prefixo, timeout=2.0):
+    limite = time.time() + timeout
+    while time.time() < limite:
+        linha = ser.readline().decode(errors='ignore').strip()
+        if linha.startswith(prefixo):
+            return linha.split()
+    raise TimeoutError(f'sem resposta "{prefixo}"')
+
+def comando(ser, texto, prefixo):
+    ser.write(texto.encode() + b'\r')
+    return ler_linha(ser, prefixo)
+
+
+# --- TESTES ---
+def teste_ping(ser, clock, n):
+    host_us, placa_us = [], []
+    for _ in range(n):
+        inicio = time.perf_counter()
+        campos = comando(ser, 'PING', 'PONG')
+        host_us.append((time.perf_counter() - inicio) * 1e6)
+        placa_us.append(int(campos[1]) * 1e6 / clock)
+    return resumo(host_us), resumo(placa_us)
+
+def teste_eco(ser, n):
+    comando(ser, 'ECHO', 'ECHO ON')
+    tempos = []
+    for i in range(n):
+        byte = bytes([0x41 + i % 26])
+        inicio = time.perf_counter()
+        ser.write(byte)
+        if ser.read(1) != byte:
+            raise RuntimeError('eco incorreto')
+        tempos.append((time.perf_counter() - inicio) * 1e6)
+    ser.write(ESC)
+    ser.read(1)
+    return resumo(tempos)
+
+def teste_tx(ser, clock, baud, n):
+    ser.reset_input_buffer()
+    ser.write(f'TX {n}\r'.encode())
+    recebidos = 0
+    inicio = None
+    pendente = b''
+    limite = time.time() + 10 + n * 10 / baud
+    while time.time() < limite:
+        bloco = ser.read(max(1, ser.in_waiting))
+        if not bloco:
+            continue
+        if inicio is None:
+            inicio = time.perf_counter()
+        pendente += bloco
+        if b'TXDONE' in pendente and pendente.endswith(b'\r\n'):
+            fim = time.perf_counter()
+            dados, _, cauda = pendente.partition(b'\r\nTXDONE')
+            recebidos += len(dados)
+            campos = cauda.split()
+            ciclos, ciclos_isr = int(campos[1]), int(campos[2])
+            return {
+                'bytes_recebidos': recebidos,
+                'host_Bps': recebidos / (fim - inicio),
+                'placa_Bps': n * clock / ciclos,
+                'limite_Bps': baud / 10,
+                'cpu_isr_pct': 100 * ciclos_isr / ciclos,
+            }
+        if len(pendente) > 64:
+            recebidos += len(pendente) - 64
+            pendente = pendente[-64:]
+    raise TimeoutError('TXDONE nao chegou')
+
+def estatisticas(ser):
+    campos = comando(ser, 'STATS', 'STATS')
+    isrs, ciclos, rx, tx, descartados, ocupacao = (int(c) for c in campos[1:7])
+    return {
+        'isrs': isrs,
+        'ciclos_por_byte': ciclos / max(1, rx + tx),
+        'bytes_por_isr': (rx + tx) / max(1, isrs),
+        'descartados': descartados,
+        'maior_ocupacao': ocupacao,
+    }
+
+
+# --- COMPARAÇÃO COM A LINHA DE BASE ---
+def comparar(atual, base, caminho=''):
+    for chave, valor in atual.items():
+        if chave not in base:
+            continue
+        nome = f'{caminho}{chave}'
+        if isinstance(valor, dict):
+            comparar(valor, base[chave], nome + '.')
+        elif isinstance(valor, (int, float)) and base[chave]:
+            delta = 100 * (valor - base[chave]) / base[chave]
+            print(f'{nome:36s} {base[chave]:12.1f} -> {valor:12.1f} ({delta:+6.1f}%)')
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('porta')
+    parser.add_argument('--baud', type=int, default=115200,
+                        help='deve ser igual ao BENCH_BAUD do firmware (conferido pelo INFO)')
+    parser.add_argument('--pings', type=int, default=200)
+    parser.add_argument('--ecos', type=int, default=500)
+    parser.add_argument('--bytes-tx', type=int, default=64 * 1024)
+    parser.add_argument('--salvar', help='grava os resultados em JSON (linha de base)')
+    parser.add_argument('--comparar', help='compara com um JSON salvo antes')
+    args = parser.parse_args()
+
+    ser = serial.Serial(args.porta, args.baud, timeout=0.5)
+    ser.reset_input_buffer()
+    info = comando(ser, 'INFO', 'BENCH')
+    clock = int(info[1])
+    if int(info[2]) != args.baud:
+        raise SystemExit(f'firmware em {info[2]} baud, mas --baud {args.baud}: '
+                         'ajuste BENCH_BAUD ou --baud')
+    comando(ser, 'RESET', 'OK')
+
+    resultados = {}
+    resultados['ping_host_us'], resultados['ping_placa_us'] = teste_ping(ser, clock, args.pings)
+    resultados['eco_host_us'] = teste_eco(ser, args.ecos)
+    resultados['tx'] = teste_tx(ser, clock, args.baud, args.bytes_tx)
+    resultados['isr'] = estatisticas(ser)
+    ser.close()
+
+    print(f'Clock da placa: {clock} Hz, {args.baud} baud')
+    imprimir_resumo('PING ida e volta (host)', resultados['ping_host_us'], 'us')
+    imprimir_resumo('PING linha -> resposta (placa)', resultados['ping_placa_us'], 'us')
+    imprimir_resumo('Eco na ISR ida e volta (host)', resultados['eco_host_us'], 'us')
+    tx = resultados['tx']
+    print(f'TX: {tx["host_Bps"]:.0f} B/s no host, {tx["placa_Bps"]:.0f} B/s na placa '
+          f'(limite {tx["limite_Bps"]:.0f} B/s), ISR {tx["cpu_isr_pct"]:.2f}% da CPU')
+    isr = resultados['isr']
+    print(f'ISR: {isr["ciclos_por_byte"]:.1f} ciclos/byte, {isr["bytes_por_isr"]:.1f} bytes/ISR, '
+          f'{isr["descartados"]} descartados, ocupacao maxima {isr["maior_ocupacao"]}')
+
+    if args.comparar:
+        with open(args.comparar) as f:
+            print(f'\nComparacao com {args.comparar}:')
+            comparar(resultados, json.load(f))
+    if args.salvar:
+        with open(args.salvar, 'w') as f:
+            json.dump(resultados, f, indent=2)
+
+
+if __name__ == '__main__':
+    main()
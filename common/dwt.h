@@ -0,0 +1,26 @@
+// Contador de ciclos do DWT (Cortex-M4) por HWREG nos enderecos fixos do
+// nucleo. Evita incluir o header de dispositivo CMSIS (TM4C129.h) junto com
+// o inc/hw_memmap.h do TivaWare, que definem os mesmos *_BASE.
+#ifndef DWT_H
+#define DWT_H
+
+#include <stdint.h>
+#include "inc/hw_types.h"
+
+#define DWT_CTRL             0xE0001000 // DWT Control
+#define DWT_CYCCNT           0xE0001004 // DWT Cycle Count
+#define DWT_DEMCR            0xE000EDFC // Debug Exception and Monitor Control
+#define DWT_CTRL_CYCCNTENA   0x00000001 // Habilita o CYCCNT
+#define DWT_DEMCR_TRCENA     0x01000000 // Liga o DWT e o ITM
+
+static inline void CycleCounterInit(void) {
+    HWREG(DWT_DEMCR) |= DWT_DEMCR_TRCENA;
+    HWREG(DWT_CYCCNT) = 0;
+    HWREG(DWT_CTRL) |= DWT_CTRL_CYCCNTENA;
+}
+
+static inline uint32_t CycleCounterGet(void) {
+    return HWREG(DWT_CYCCNT);
+}
+
+#endif
@@ -0,0 +1,71 @@
+#include <stdint.h>
+#include "fmt.h"
+
+void fmtStr(FmtBuf *f, const char *s) {
+    while (*s) {
+        fmtChar(f, *s++);
+    }
+}
+
+void fmtU32Pad(FmtBuf *f, uint32_t v, uint32_t minDigits) {
+    char tmp[FMT_U32_MAX_DIGITS];
+    uint32_t n = 0;
+    do {
+        tmp[n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v != 0);
+    while (n < minDigits && n < FMT_U32_MAX_DIGITS) {
+        tmp[n++] = '0';
+    }
+    while (n > 0) {
+        fmtChar(f, tmp[--n]);
+    }
+}
+
+void fmtI32(FmtBuf *f, int32_t v) {
+    if (v < 0) {
+        fmtChar(f, '-');
+        fmtU32(f, 0u - (uint32_t)v);
+    } else {
+        fmtU32(f, (uint32_t)v);
+    }
+}
+
+void fmtHex32(FmtBuf *f, uint32_t v, uint32_t digits) {
+    static const char hex[] = "0123456789ABCDEF";
+    if (digits == 0 || digits > 8) digits = 8;
+    for (int32_t shift = (int32_t)(digits - 1) * 4; shift >= 0; shift -= 4) {
+        fmtChar(f, hex[(v >> shift) & 0xF]);
+    }
+}
+
+// 10^fracDigits sem estourar: acima de FMT_FRAC_MAX_DIGITS casas o uint32_t
+// daria a volta e o resultado sairia errado sem aviso
+static uint32_t fmtFracScale(uint32_t *fracDigits) {
+    uint32_t scale = 1;
+    if (*fracDigits > FMT_FRAC_MAX_DIGITS) {
+        *fracDigits = FMT_FRAC_MAX_DIGITS;
+    }
+    for (uint32_t i = 0; i < *fracDigits; i++) scale *= 10;
+    return scale;
+}
+
+void fmtFixed(FmtBuf *f, int32_t value, uint32_t fracDigits) {
+    uint32_t scale = fmtFracScale(&fracDigits);
+    uint32_t mag = (value < 0) ? 0u - (uint32_t)value : (uint32_t)value;
+    if (value < 0) fmtChar(f, '-');
+    fmtU32(f, mag / scale);
+    if (fracDigits > 0) {
+        fmtChar(f, '.');
+        fmtU32Pad(f, mag % scale, fracDigits);
+    }
+}
+
+void fmtScaled(FmtBuf *f, uint64_t num, uint32_t den, uint32_t fracDigits) {
+    uint32_t scale = fmtFracScale(&fracDigits);
+    fmtU32(f, (uint32_t)(num / den));
+    if (fracDigits > 0) {
+        fmtChar(f, '.');
+        fmtU32Pad(f, (uint32_t)(((num % den) * scale) / den), fracDigits);
+    }
+}
@@ -0,0 +1,55 @@
+// Formatacao rapida de numeros (substitui snprintf nos caminhos criticos).
+// Cada chamada tem tipo fixo, entao o compilador confere os argumentos
+// (ao contrario do printf com varargs). Nao aloca memoria e pode rodar em ISR.
+// A saida e truncada em size-1 caracteres e sempre termina com '\0'.
+#ifndef FMT_H
+#define FMT_H
+
+#include <stdint.h>
+
+typedef struct {
+    char *buf;
+    uint32_t size;
+    uint32_t len;
+} FmtBuf;
+
+#define FMT_U32_MAX_DIGITS  10
+#define FMT_FRAC_MAX_DIGITS 9 // 10^9 e a maior potencia de 10 em uint32_t
+
+static inline void fmtInit(FmtBuf *f, char *buf, uint32_t size) {
+    f->buf = buf;
+    f->size = size;
+    f->len = 0;
+    buf[0] = '\0';
+}
+
+static inline void fmtChar(FmtBuf *f, char c) {
+    if (f->len + 1 < f->size) {
+        f->buf[f->len++] = c;
+        f->buf[f->len] = '\0';
+    }
+}
+
+void fmtStr(FmtBuf *f, const char *s);
+
+// Decimal sem sinal; minDigits > 0 completa com zeros a esquerda
+void fmtU32Pad(FmtBuf *f, uint32_t v, uint32_t minDigits);
+
+static inline void fmtU32(FmtBuf *f, uint32_t v) {
+    fmtU32Pad(f, v, 0);
+}
+
+void fmtI32(FmtBuf *f, int32_t v);
+
+// digits = 0 ou > 8 escreve os 8 digitos
+void fmtHex32(FmtBuf *f, uint32_t v, uint32_t digits);
+
+// Ponto fixo: value ja esta multiplicado por 10^fracDigits (ex: 2534, 2 -> "25.34").
+// fracDigits acima de FMT_FRAC_MAX_DIGITS e limitado a FMT_FRAC_MAX_DIGITS.
+void fmtFixed(FmtBuf *f, int32_t value, uint32_t fracDigits);
+
+// Razao num/den com fracDigits casas (truncado), sem ponto flutuante.
+// fracDigits acima de FMT_FRAC_MAX_DIGITS e limitado a FMT_FRAC_MAX_DIGITS.
+void fmtScaled(FmtBuf *f, uint64_t num, uint32_t den, uint32_t fracDigits);
+
+#endif
@@ -0,0 +1,60 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include "inc/hw_memmap.h"
+#include "driverlib/uart.h"
+#include "driverlib/interrupt.h"
+#include "uart_tx.h"
+
+static volatile uint8_t uartTxBuffer[UART_TX_BUFFER_SIZE];
+static volatile uint32_t uartTxHead = 0; // Avancado por quem envia
+static volatile uint32_t uartTxTail = 0; // Avancado pela interrupcao TX
+volatile uint32_t uartTxDropped = 0;
+volatile uint32_t uartTxHighWater = 0;
+
+// Passa bytes do buffer para o FIFO da UART enquanto houver espaco.
+// A interrupcao TX so fica habilitada enquanto ainda ha bytes pendentes.
+uint32_t UARTTxPump(void) {
+    uint32_t moved = 0;
+    while (uartTxTail != uartTxHead && UARTSpaceAvail(UART0_BASE)) {
+        UARTCharPutNonBlocking(UART0_BASE, uartTxBuffer[uartTxTail & (UART_TX_BUFFER_SIZE - 1)]);
+        uartTxTail++;
+        moved++;
+    }
+    if (uartTxTail == uartTxHead) {
+        UARTIntDisable(UART0_BASE, UART_INT_TX);
+    } else {
+        UARTIntEnable(UART0_BASE, UART_INT_TX);
+    }
+    return moved;
+}
+
+// Retorna quantos bytes couberam; o restante e contado em uartTxDropped.
+uint32_t UARTWrite(const uint8_t *data, uint32_t len) {
+    bool wasDisabled = IntMasterDisable();
+    uint32_t used = uartTxHead - uartTxTail;
+    uint32_t space = UART_TX_BUFFER_SIZE - used;
+    uint32_t count = (len < space) ? len : space;
+
+    for (uint32_t i = 0; i < count; i++) {
+        uartTxBuffer[(uartTxHead + i) & (UART_TX_BUFFER_SIZE - 1)] = data[i];
+    }
+    uartTxHead += count;
+    uartTxDropped += len - count;
+    if (used + count > uartTxHighWater) {
+        uartTxHighWater = used + count;
+    }
+    UARTTxPump();
+
+    if (!wasDisabled) {
+        IntMasterEnable();
+    }
+    return count;
+}
+
+uint32_t UARTTxSpace(void) {
+    return UART_TX_BUFFER_SIZE - (uartTxHead - uartTxTail);
+}
+
+bool UARTTxIdle(void) {
+    return uartTxTail == uartTxHead && !UARTBusy(UART0_BASE);
+}
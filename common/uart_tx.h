@@ -0,0 +1,27 @@
+// Transmissao UART0 nao bloqueante (buffer circular + interrupcao TX)
+// compartilhada pelos projetos. O projeto continua dono do UARTIntHandler:
+// ele so precisa chamar UARTTxPump() quando o status tiver UART_INT_TX.
+#ifndef UART_TX_H
+#define UART_TX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define UART_TX_BUFFER_SIZE 256 // Precisa ser potencia de 2
+
+extern volatile uint32_t uartTxDropped;   // Bytes descartados por buffer cheio
+extern volatile uint32_t uartTxHighWater; // Maior ocupacao ja vista do buffer
+
+// Passa bytes do buffer para o FIFO; retorna quantos foram para o FIFO
+uint32_t UARTTxPump(void);
+
+// Enfileira ate len bytes sem bloquear (pode ser chamada de ISR)
+uint32_t UARTWrite(const uint8_t *data, uint32_t len);
+
+// Bytes livres no buffer neste instante
+uint32_t UARTTxSpace(void);
+
+// Buffer vazio e ultimo bit ja saiu do pino
+bool UARTTxIdle(void);
+
+#endif
@@ -1,5 +1,6 @@
 #include <stdint.h>
 #include <stdbool.h>
+#include <string.h>
 #include "inc/hw_memmap.h"
 #include "inc/hw_types.h"
 #include "driverlib/sysctl.h"
@@ -7,6 +8,7 @@
 #include "driverlib/uart.h"
 #include "driverlib/pin_map.h"
 #include "driverlib/interrupt.h"
+#include "uart_tx.h"
 
 #define LED_PORTN GPIO_PORTN_BASE
 #define LED_PORTF GPIO_PORTF_BASE
@@ -23,12 +25,8 @@ volatile char rxbuffer = 0;
 
 void UARTSendString(const char *str);
 
-// Handler UART
-void UARTIntHandler(void) {
-    uint32_t status = UARTIntStatus(UART0_BASE, true);
-    UARTIntClear(UART0_BASE, status);
-
-    uint8_t received = (uint8_t)UARTCharGetNonBlocking(UART0_BASE);
+// Trata um caractere recebido pela UART
+static void UARTHandleChar(uint8_t received) {
 		if (received == '\r') { // ENTER foi apertado
         switch (rxbuffer) {
             case '1':
@@ -69,13 +67,29 @@ void UARTIntHandler(void) {
     }
 }
 
+// Handler UART
+void UARTIntHandler(void) {
+    uint32_t status = UARTIntStatus(UART0_BASE, true);
+    UARTIntClear(UART0_BASE, status);
+
+    // Com o FIFO ligado podem chegar varios caracteres por interrupcao
+    while (UARTCharsAvail(UART0_BASE)) {
+        UARTHandleChar((uint8_t)UARTCharGetNonBlocking(UART0_BASE));
+    }
+    if (status & UART_INT_TX) {
+        UARTTxPump();
+    }
+}
+
 // UART configurao
 void SetupUart(void) {
     SysCtlPeripheralEnable(SYSCTL_PERIPH_UART0);
     while(!SysCtlPeripheralReady(SYSCTL_PERIPH_UART0));
     UARTConfigSetExpClk(UART0_BASE, SysClock, 115200, (UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE));
-    UARTFIFODisable(UART0_BASE);
-    UARTIntEnable(UART0_BASE, UART_INT_RX);
+    UARTFIFOEnable(UART0_BASE);
+    UARTFIFOLevelSet(UART0_BASE, UART_FIFO_TX2_8, UART_FIFO_RX1_8);
+    UARTTxIntModeSet(UART0_BASE, UART_TXINT_MODE_FIFO);
+    UARTIntEnable(UART0_BASE, UART_INT_RX | UART_INT_RT);
     UARTIntRegister(UART0_BASE, UARTIntHandler);
     SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOA);
     while(!SysCtlPeripheralReady(SYSCTL_PERIPH_GPIOA));
@@ -99,9 +113,7 @@ void ConfigPBs(void){
 }
 	// Enviar string pela UART
 void UARTSendString(const char *str) {
-    while (*str != '\0') {
-        UARTCharPut(UART0_BASE, *str++);
-    }
+    UARTWrite((const uint8_t *)str, strlen(str));
 }
 
 int main(void) {
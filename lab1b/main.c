@@ -8,7 +8,9 @@
 #include "driverlib/pin_map.h"
 #include "driverlib/interrupt.h"
 #include "driverlib/systick.h"
+#include "uart_tx.h"
 #include <stdio.h>
+#include <string.h>
 
 // Definições de tempo
 #define TIMEOUT_MS    5000
@@ -118,12 +120,28 @@ void ledsOn(int leds) {
     }
 }
 
+void UARTIntHandler(void) {
+    uint32_t status = UARTIntStatus(UART0_BASE, true);
+    UARTIntClear(UART0_BASE, status);
+
+    while (UARTCharsAvail(UART0_BASE)) {
+        UARTCharGetNonBlocking(UART0_BASE);
+    }
+    if (status & UART_INT_TX) {
+        UARTTxPump();
+    }
+}
+
 void SetupUart(void) {
     SysCtlPeripheralEnable(SYSCTL_PERIPH_UART0);
     while (!SysCtlPeripheralReady(SYSCTL_PERIPH_UART0));
     UARTConfigSetExpClk(UART0_BASE, sysClock, 115200,
                         (UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE));
-    UARTFIFODisable(UART0_BASE);
+    UARTFIFOEnable(UART0_BASE);
+    UARTFIFOLevelSet(UART0_BASE, UART_FIFO_TX2_8, UART_FIFO_RX4_8);
+    UARTTxIntModeSet(UART0_BASE, UART_TXINT_MODE_FIFO);
+    UARTIntEnable(UART0_BASE, UART_INT_RX | UART_INT_RT);
+    UARTIntRegister(UART0_BASE, UARTIntHandler);
 
     SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOA);
     while (!SysCtlPeripheralReady(SYSCTL_PERIPH_GPIOA));
@@ -154,9 +172,7 @@ void ConfigPBs(void) {
 }
 
 void UARTSendString(const char *str) {
-    while (*str != '\0') {
-        UARTCharPut(UART0_BASE, *str++);
-    }
+    UARTWrite((const uint8_t *)str, strlen(str));
 }
 
 int main(void) {
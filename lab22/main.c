@@ -11,9 +11,16 @@
 #include "driverlib/systick.h"
 #include "driverlib/timer.h"
 #include "driverlib/adc.h"
+#include "fmt.h"
+#include "dwt.h"
+#include "cmsis_compiler.h" // __SMLAD e __SSAT, sem o header de dispositivo
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
-#define ADC_SEQUENCER 3 // Usando o sequenciador 3 do ADC para uma única amostra
+#define ADC_SEQUENCER 0 // Sequenciador 0: varredura de ate 8 canais por gatilho
+#define ADC_SAMPLE_HZ 100 // Timer0 dispara as conversoes nesta taxa
+#define ADC_SCALE_SHIFT 4 // Media, DSP e ASCII16 em escala de 16 bits (12 bits << 4)
 
 uint32_t SysClock;
 
@@ -42,6 +49,7 @@ typedef enum {
 #define LEDS_ON_123   2
 #define LEDS_ON_ALL  3
 
+// Limiares dos estados em graus (sm.jpg)
 #define LOW 25
 #define MEDIUM 30
 #define HIGH 35
@@ -55,8 +63,11 @@ bool g_bFadeUp = true; //Controle e direcao do fade.
 
 void setupPWM(void);
 void setupTimer(void);
-void Timer0IntHandler(void);
+void ADC0Seq0IntHandler(void);
 void UARTSend(const char *pui8Buffer);
+uint32_t CobsEncode(const uint8_t *src, uint32_t len, uint8_t *dst);
+void StateComparatorsSet(State s);
+void StateDutySet(State s);
 
 void ledsOn(int leds) {
     uint8_t portN_value = 0;
@@ -89,70 +100,1642 @@ void ledsOn(int leds) {
     GPIOPinWrite(LED_PORTF, LED_PIN_0 | LED_PIN_4, portF_value);
 }
 
+// --- Transmissao UART0 em canais logicos (buffers circulares + interrupcao TX) ---
+// Cada canal tem seu proprio buffer e cada mensagem e enfileirada inteira
+// (ou descartada inteira), precedida por um byte de tamanho. A interrupcao TX
+// so troca de canal entre mensagens:
+//  - CTRL (respostas a comandos) tem prioridade absoluta;
+//  - LOG e DATA dividem o resto da banda por deficit round robin, cada um
+//    com sua cota de bytes por rodada (UART_CH_*_QUANTUM).
+// Com o multiplexador ligado ("MUX ON") cada mensagem vira um quadro
+// COBS(canal | dados) terminado em 0x00; desligado, os bytes saem como antes.
+#define UART_CH_CTRL 0
+#define UART_CH_LOG  1
+#define UART_CH_DATA 2
+#define UART_CH_COUNT 3
+
+#define UART_CH_CTRL_SIZE 128 // Tamanhos precisam ser potencia de 2
+#define UART_CH_LOG_SIZE  128
+#define UART_CH_DATA_SIZE 512
+#define UART_CH_LOG_QUANTUM  64  // Bytes por rodada: LOG fica com 1/4 da banda
+#define UART_CH_DATA_QUANTUM 192 // e DATA com 3/4 quando os dois tem fila
+#define UART_TX_MSG_MAX 64       // Maior mensagem (ja com quadro); <= menor cota
+
+typedef struct {
+    volatile uint8_t *buffer;
+    uint32_t size;
+    volatile uint32_t head;    // Avancado por quem envia
+    volatile uint32_t tail;    // Avancado pela interrupcao TX
+    uint32_t quantum;          // Cota por rodada (0 = prioridade absoluta)
+    uint32_t deficit;          // Bytes que ainda pode enviar nesta rodada
+    volatile uint32_t dropped; // Mensagens descartadas por buffer cheio
+    uint32_t highWater;        // Maior ocupacao ja vista do buffer
+} UartChannel;
+
+static volatile uint8_t uartChCtrlBuffer[UART_CH_CTRL_SIZE];
+static volatile uint8_t uartChLogBuffer[UART_CH_LOG_SIZE];
+static volatile uint8_t uartChDataBuffer[UART_CH_DATA_SIZE];
+
+UartChannel uartChannels[UART_CH_COUNT] = {
+    { uartChCtrlBuffer, UART_CH_CTRL_SIZE, 0, 0, 0, 0, 0, 0 },
+    { uartChLogBuffer, UART_CH_LOG_SIZE, 0, 0, UART_CH_LOG_QUANTUM, 0, 0, 0 },
+    { uartChDataBuffer, UART_CH_DATA_SIZE, 0, 0, UART_CH_DATA_QUANTUM, 0, 0, 0 },
+};
+
+bool uartMuxEnabled = false;
+// Canais assinados pelo host (bit n = canal n); CTRL sempre sai.
+// LOG comeca ligado para a telemetria do tacometro ("TEL") sair sem um SUB.
+// Sem multiplexador as linhas de LOG terminam em 0x00: o host em ASCII ignora
+// linhas que nao sao numero e o decodificador binario se sincroniza nelas.
+// "SUB 5" volta ao fluxo so com CTRL e DATA.
+uint32_t uartChSubscribed = (1u << UART_CH_CTRL) | (1u << UART_CH_LOG) | (1u << UART_CH_DATA);
+
+static uint32_t uartTxChannel = 0;   // Canal da mensagem em andamento
+static uint32_t uartTxRemaining = 0; // Bytes que faltam dessa mensagem
+static uint32_t uartTxRound = UART_CH_LOG; // Proximo canal no round robin
+
+static inline bool UartChannelEmpty(const UartChannel *ch) {
+    return ch->head == ch->tail;
+}
+
+// Escolhe o canal da proxima mensagem e consome o byte de tamanho dela
+static bool UARTTxSelect(void) {
+    UartChannel *ch = &uartChannels[UART_CH_CTRL];
+
+    if (UartChannelEmpty(ch)) {
+        ch = NULL;
+        // O canal da vez envia enquanto tiver deficit; ao passar a vez o
+        // proximo ganha sua cota. Com cota >= UART_TX_MSG_MAX uma volta basta.
+        for (uint32_t i = 0; i < UART_CH_COUNT; i++) {
+            UartChannel *candidate = &uartChannels[uartTxRound];
+            if (UartChannelEmpty(candidate)) {
+                candidate->deficit = 0;
+            } else if (candidate->deficit >= candidate->buffer[candidate->tail & (candidate->size - 1)]) {
+                ch = candidate;
+                break;
+            }
+            uartTxRound = (uartTxRound == UART_CH_COUNT - 1) ? UART_CH_LOG : uartTxRound + 1;
+            uartChannels[uartTxRound].deficit += uartChannels[uartTxRound].quantum;
+        }
+        if (ch == NULL) {
+            return false;
+        }
+    }
+
+    uartTxChannel = (uint32_t)(ch - uartChannels);
+    uartTxRemaining = ch->buffer[ch->tail & (ch->size - 1)];
+    ch->tail++;
+    if (ch->quantum != 0) {
+        ch->deficit -= uartTxRemaining;
+    }
+    return true;
+}
+
+static bool UARTTxPending(void) {
+    for (uint32_t i = 0; i < UART_CH_COUNT; i++) {
+        if (!UartChannelEmpty(&uartChannels[i])) {
+            return true;
+        }
+    }
+    return uartTxRemaining != 0;
+}
+
+// Passa bytes dos canais para o FIFO da UART enquanto houver espaco.
+// A interrupcao TX so fica habilitada enquanto ainda ha bytes pendentes.
+static void UARTTxPump(void) {
+    while (UARTSpaceAvail(UART0_BASE)) {
+        if (uartTxRemaining == 0 && !UARTTxSelect()) {
+            break;
+        }
+        UartChannel *ch = &uartChannels[uartTxChannel];
+        UARTCharPutNonBlocking(UART0_BASE, ch->buffer[ch->tail & (ch->size - 1)]);
+        ch->tail++;
+        uartTxRemaining--;
+    }
+    if (UARTTxPending()) {
+        UARTIntEnable(UART0_BASE, UART_INT_TX);
+    } else {
+        UARTIntDisable(UART0_BASE, UART_INT_TX);
+    }
+}
+
+// Enfileira uma mensagem inteira no canal sem bloquear (pode ser chamada de ISR).
+// Retorna false se o canal nao esta assinado ou se a mensagem foi descartada.
+bool ChannelWrite(uint32_t channel, const uint8_t *data, uint32_t len) {
+    uint8_t framed[UART_TX_MSG_MAX];
+    UartChannel *ch = &uartChannels[channel];
+    bool queued = false;
+
+    if (!(uartChSubscribed & (1u << channel))) {
+        return false;
+    }
+    if (uartMuxEnabled) {
+        uint8_t raw[UART_TX_MSG_MAX];
+        if (len + 1 > UART_TX_MSG_MAX - 3) {
+            ch->dropped++;
+            return false;
+        }
+        raw[0] = (uint8_t)channel;
+        memcpy(&raw[1], data, len);
+        len = CobsEncode(raw, len + 1, framed);
+        framed[len++] = 0x00;
+        data = framed;
+    } else if (len > UART_TX_MSG_MAX) {
+        ch->dropped++;
+        return false;
+    }
+
+    bool wasDisabled = IntMasterDisable();
+    uint32_t used = ch->head - ch->tail;
+    if (used + len + 1 <= ch->size) {
+        ch->buffer[ch->head & (ch->size - 1)] = (uint8_t)len;
+        for (uint32_t i = 0; i < len; i++) {
+            ch->buffer[(ch->head + 1 + i) & (ch->size - 1)] = data[i];
+        }
+        ch->head += len + 1;
+        if (used + len + 1 > ch->highWater) {
+            ch->highWater = used + len + 1;
+        }
+        queued = true;
+        UARTTxPump();
+    } else {
+        ch->dropped++;
+    }
+    if (!wasDisabled) {
+        IntMasterEnable();
+    }
+    return queued;
+}
+
+// Texto em CTRL/LOG. Sem o multiplexador a mensagem termina com 0x00 para o
+// decodificador binario do host descarta-la e se sincronizar no proximo quadro.
+bool ChannelPrint(uint32_t channel, const char *text) {
+    uint32_t len = strlen(text);
+    return ChannelWrite(channel, (const uint8_t *)text, uartMuxEnabled ? len : len + 1);
+}
+
+void UARTSend(const char *pui8Buffer) {
+    ChannelPrint(UART_CH_LOG, pui8Buffer);
+}
+
+// --- Comandos de texto recebidos pela UART (uma linha por comando) ---
+// Maior linha: "CURVE SET" com CURVE_POINTS_MAX pontos "4095:100" (conferido
+// na secao da curva). Linha maior que o buffer e rejeitada inteira com ERR.
+#define CMD_BUFFER_SIZE 96
+
+char cmdBuffer[CMD_BUFFER_SIZE];
+uint32_t cmdIndex = 0;
+bool cmdOverflow = false;       // A linha atual nao coube no buffer
+char cmdLine[CMD_BUFFER_SIZE];  // Linha completa, tratada fora da ISR
+volatile bool cmdReady = false;
+
 void UARTIntHandler(void) {
     uint32_t status = UARTIntStatus(UART0_BASE, true);
     UARTIntClear(UART0_BASE, status);
+
+    while (UARTCharsAvail(UART0_BASE)) {
+        char c = (char)UARTCharGetNonBlocking(UART0_BASE);
+        if (c == '\r' || c == '\n') {
+            // Se o comando anterior ainda nao foi tratado, o novo e descartado
+            if (cmdIndex > 0 && !cmdReady) {
+                cmdBuffer[cmdIndex] = '\0';
+                // Linha truncada vai vazia: nenhum comando casa e a resposta e ERR
+                strcpy(cmdLine, cmdOverflow ? "" : cmdBuffer);
+                cmdReady = true;
+            }
+            cmdIndex = 0;
+            cmdOverflow = false;
+        } else if (cmdIndex < CMD_BUFFER_SIZE - 1) {
+            cmdBuffer[cmdIndex++] = c;
+        } else {
+            cmdOverflow = true;
+        }
+    }
+    if (status & UART_INT_TX) {
+        UARTTxPump();
+    }
 }
 
-void Timer0IntHandler(void) {
-    // Limpa a interrupção do Timer0
-    TimerIntClear(TIMER0_BASE, TIMER_TIMA_TIMEOUT);
+// --- Streaming do ADC: ASCII ("%u\r\n") ou binario em quadros COBS ---
+// Quadro binario (antes do COBS): seq | n | amostras empacotadas | CRC16 (LSB primeiro)
+// Duas amostras de 12 bits ocupam 3 bytes: b0 = a0[7:0], b1 = a0[11:8] | a1[3:0] << 4,
+// b2 = a1[11:4]. Cada quadro codificado termina com 0x00.
+// ASCII e binario mandam a vista de 12 bits de sempre; ASCII16 manda o valor na
+// escala de 16 bits (0..65520), com os bits ganhos pelo oversampling.
+#define STREAM_ASCII   0
+#define STREAM_BINARY  1
+#define STREAM_ASCII16 2
 
-    // Dispara leitura do ADC
-    ADCProcessorTrigger(ADC0_BASE, ADC_SEQUENCER);
-    while(!ADCIntStatus(ADC0_BASE, ADC_SEQUENCER, false));
-    ADCIntClear(ADC0_BASE, ADC_SEQUENCER);
-    ADCSequenceDataGet(ADC0_BASE, ADC_SEQUENCER, &adcValue);
-
-    // Mostra valor do ADC via UART
-    char buffer[10];
-    int len = snprintf(buffer, sizeof(buffer), "%u\r\n", adcValue);
-    for (int i = 0; i < len; i++) {
-        UARTCharPut(UART0_BASE, buffer[i]);
-    }
-
-    // Define estado conforme valor do ADC
-    if (adcValue < 1024) {
-        currentState = STATE_OFF;
-    } else if (adcValue < 2048) {
-        currentState = STATE_LOW;
-    } else if (adcValue < 3072) {
-        currentState = STATE_MEDIUM;
+#define FRAME_SAMPLES 16 // Precisa ser par
+#define FRAME_PAYLOAD_SIZE (2 + (FRAME_SAMPLES / 2) * 3 + 2)
+#define FRAME_ENCODED_SIZE (FRAME_PAYLOAD_SIZE + FRAME_PAYLOAD_SIZE / 254 + 2)
+
+volatile uint8_t streamMode = STREAM_ASCII;
+volatile bool streamPaused = false; // Durante a negociacao do baud rate
+uint16_t frameSamples[FRAME_SAMPLES];
+uint32_t frameCount = 0;
+uint8_t frameSeq = 0;
+
+// CRC-16/CCITT-FALSE (polinomio 0x1021, valor inicial 0xFFFF)
+uint16_t Crc16Ccitt(const uint8_t *data, uint32_t len) {
+    uint16_t crc = 0xFFFF;
+    for (uint32_t i = 0; i < len; i++) {
+        crc ^= (uint16_t)data[i] << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+// Codifica src em COBS (sem o 0x00 final). Retorna o tamanho escrito em dst.
+uint32_t CobsEncode(const uint8_t *src, uint32_t len, uint8_t *dst) {
+    uint32_t out = 1;
+    uint32_t codeIndex = 0;
+    uint8_t code = 1;
+
+    for (uint32_t i = 0; i < len; i++) {
+        if (src[i] == 0) {
+            dst[codeIndex] = code;
+            codeIndex = out++;
+            code = 1;
+        } else {
+            dst[out++] = src[i];
+            code++;
+            if (code == 0xFF) {
+                dst[codeIndex] = code;
+                codeIndex = out++;
+                code = 1;
+            }
+        }
+    }
+    dst[codeIndex] = code;
+    return out;
+}
+
+// Com o multiplexador ligado o quadro ja sai em COBS pelo canal DATA
+static void StreamSendFrame(void) {
+    uint8_t payload[FRAME_PAYLOAD_SIZE];
+    uint8_t encoded[FRAME_ENCODED_SIZE];
+    uint32_t pos = 0;
+
+    payload[pos++] = frameSeq++;
+    payload[pos++] = FRAME_SAMPLES;
+    for (uint32_t i = 0; i < FRAME_SAMPLES; i += 2) {
+        uint16_t a0 = frameSamples[i] & 0x0FFF;
+        uint16_t a1 = frameSamples[i + 1] & 0x0FFF;
+        payload[pos++] = (uint8_t)a0;
+        payload[pos++] = (uint8_t)((a0 >> 8) | ((a1 & 0x0F) << 4));
+        payload[pos++] = (uint8_t)(a1 >> 4);
+    }
+    uint16_t crc = Crc16Ccitt(payload, pos);
+    payload[pos++] = (uint8_t)crc;
+    payload[pos++] = (uint8_t)(crc >> 8);
+
+    if (uartMuxEnabled) {
+        ChannelWrite(UART_CH_DATA, payload, pos);
+        return;
+    }
+    uint32_t len = CobsEncode(payload, pos, encoded);
+    encoded[len++] = 0x00;
+    ChannelWrite(UART_CH_DATA, encoded, len);
+}
+
+// Vista de 12 bits (arredondada) de um valor na escala de 16 bits
+static inline uint32_t AdcTo12(uint32_t value16) {
+    uint32_t v = (value16 + (1u << (ADC_SCALE_SHIFT - 1))) >> ADC_SCALE_SHIFT;
+    return (v > 4095) ? 4095 : v;
+}
+
+// Envia uma amostra (escala de 16 bits) no modo atual (chamada a partir da ISR do ADC/timer)
+void StreamSample(uint32_t sample16) {
+    if (streamPaused) {
+        return;
+    }
+    uint32_t sample = (streamMode == STREAM_ASCII16) ? sample16 : AdcTo12(sample16);
+    if (streamMode == STREAM_BINARY) {
+        frameSamples[frameCount++] = (uint16_t)sample;
+        if (frameCount == FRAME_SAMPLES) {
+            StreamSendFrame();
+            frameCount = 0;
+        }
     } else {
-        currentState = STATE_HIGH;
+        char buffer[FMT_U32_MAX_DIGITS + 3];
+        FmtBuf f;
+        fmtInit(&f, buffer, sizeof(buffer));
+        fmtU32(&f, sample);
+        fmtStr(&f, "\r\n");
+        ChannelWrite(UART_CH_DATA, (const uint8_t *)buffer, f.len);
     }
+}
 
-    // PWM fixo com base no estado
-    uint32_t load = PWMGenPeriodGet(PWM0_BASE, PWM_GEN_2);
-    uint32_t pulseWidth = 0;
+// Troca o modo de streaming descartando um quadro binario incompleto
+void StreamSetMode(uint8_t mode) {
+    bool wasDisabled = IntMasterDisable();
+    streamMode = mode;
+    frameCount = 0;
+    if (!wasDisabled) {
+        IntMasterEnable();
+    }
+}
+
+// --- Varredura de canais: um gatilho do Timer0 converte todos os canais no seq0 ---
+// Ate 8 passos (FIFO do seq0). Para incluir um canal externo, acrescente-o na
+// tabela e configure o pino com GPIOPinTypeADC em SetupADC.
+typedef struct {
+    uint32_t adcCtl;   // ADC_CTL_CHn ou ADC_CTL_TS (+ opcoes do passo)
+    const char *name;
+} ScanChannel;
+
+static const ScanChannel scanChannels[] = {
+    { ADC_CTL_CH9, "AIN9" },                   // PE4: sensor que controla o cooler
+    { ADC_CTL_TS | ADC_CTL_SHOLD_16, "TEMP" }, // Sensor interno (pede amostragem mais longa)
+};
+
+#define SCAN_CHANNEL_COUNT (sizeof(scanChannels) / sizeof(scanChannels[0]))
+#define SCAN_MAX_CHANNELS  8
+#define SCAN_IDX_COOLER    0
+#define SCAN_IDX_TEMP      1
+
+// Quadro de uma varredura (struct of arrays: um vetor por campo, indexado pelo canal).
+// A ISR escreve um quadro enquanto o outro fica publicado em scanLatest.
+typedef struct {
+    uint32_t seq;                        // Numero da varredura
+    uint16_t raw[SCAN_MAX_CHANNELS];     // Contagens de 12 bits
+} ScanFrame;
+
+ScanFrame scanFrames[2];
+volatile uint32_t scanLatest = 0;        // Indice do quadro publicado
+volatile uint32_t scanErrors = 0;        // Varreduras com numero errado de amostras
+
+// Le todas as amostras do FIFO do seq0 e publica o quadro
+static const ScanFrame *ScanCollect(void) {
+    uint32_t samples[SCAN_MAX_CHANNELS];
+    uint32_t next = scanLatest ^ 1;
+    ScanFrame *frame = &scanFrames[next];
+
+    uint32_t count = ADCSequenceDataGet(ADC0_BASE, ADC_SEQUENCER, samples);
+    if (count != SCAN_CHANNEL_COUNT) {
+        scanErrors++;
+    }
+    for (uint32_t i = 0; i < SCAN_CHANNEL_COUNT; i++) {
+        frame->raw[i] = (i < count) ? (uint16_t)samples[i] : 0;
+    }
+    frame->seq = scanFrames[scanLatest].seq + 1;
+    scanLatest = next;
+    return frame;
+}
+
+// Temperatura interna em decimos de grau: T = 147.5 - 75 * 3.3 * ADC / 4096
+static int32_t ScanTempTenths(uint32_t raw) {
+    return 1475 - (int32_t)((2475 * raw) / 4096);
+}
+
+// Resposta ao comando "SCAN": "SCAN <seq> AIN9=<n> TEMP=<n> T=<graus>"
+static void ScanReport(void) {
+    ScanFrame frame;
+    char buffer[64];
+    FmtBuf f;
 
-    switch (currentState) {
-        case STATE_OFF:
-            pulseWidth = 0;
+    bool wasDisabled = IntMasterDisable();
+    frame = scanFrames[scanLatest];
+    if (!wasDisabled) {
+        IntMasterEnable();
+    }
+
+    fmtInit(&f, buffer, sizeof(buffer));
+    fmtStr(&f, "SCAN ");
+    fmtU32(&f, frame.seq);
+    for (uint32_t i = 0; i < SCAN_CHANNEL_COUNT; i++) {
+        fmtChar(&f, ' ');
+        fmtStr(&f, scanChannels[i].name);
+        fmtChar(&f, '=');
+        fmtU32(&f, frame.raw[i]);
+    }
+    fmtStr(&f, " T=");
+    fmtFixed(&f, ScanTempTenths(frame.raw[SCAN_IDX_TEMP]), 1);
+    fmtStr(&f, "\r\n");
+    ChannelPrint(UART_CH_CTRL, buffer);
+}
+
+// --- Media: oversampling no hardware + decimador boxcar (CIC de 1a ordem) ---
+// O hardware tira a media de avgHwFactor conversoes por passo (mesma taxa de
+// gatilho); o firmware soma 2^avgDecLog2 resultados e entrega um valor em escala
+// de 16 bits a ADC_SAMPLE_HZ / 2^avgDecLog2. Cada media de 4 amostras ganha
+// ~1 bit efetivo, ate o limite de 16 bits da escala. Esse valor segue inteiro
+// para o DSP e o MODE ASCII16; adcValue e so a vista de 12 bits (calibracao,
+// comparadores e controle, que trabalham em contagens de 12 bits).
+#define AVG_HW_MAX       64
+#define AVG_DEC_MAX_LOG2 8  // Ate 256 amostras por saida
+
+uint32_t avgHwFactor = 1;   // 1 = oversampling do hardware desligado
+uint32_t avgDecLog2 = 0;    // 0 = sem decimacao
+uint32_t avgSum = 0;
+uint32_t avgCount = 0;
+volatile uint32_t adcValue16 = 0; // Saida filtrada em escala de 16 bits (0..65520)
+
+// Acumula uma amostra; retorna true quando sai um novo valor filtrado
+static bool AvgPush(uint32_t raw) {
+    avgSum += raw;
+    if (++avgCount < (1u << avgDecLog2)) {
+        return false;
+    }
+    adcValue16 = (avgSum << ADC_SCALE_SHIFT) >> avgDecLog2;
+    avgSum = 0;
+    avgCount = 0;
+    return true;
+}
+
+static uint32_t Log2Exact(uint32_t v) {
+    uint32_t n = 0;
+    while (n < 31 && (1u << n) < v) n++;
+    return ((1u << n) == v) ? n : 0xFFFFFFFFu;
+}
+
+// Bits efetivos em decimos: 12 + log2(amostras por saida) / 2, no maximo 16
+static uint32_t AvgEffectiveBitsTenths(void) {
+    uint32_t bits = 120 + 5 * (Log2Exact(avgHwFactor) + avgDecLog2);
+    return (bits > 160) ? 160 : bits;
+}
+
+// Fatores precisam ser potencia de 2: hw 1..64, dec 1..256
+static bool AvgConfigure(uint32_t hw, uint32_t dec) {
+    uint32_t decLog2 = Log2Exact(dec);
+    if (hw < 1 || hw > AVG_HW_MAX || Log2Exact(hw) == 0xFFFFFFFFu || decLog2 > AVG_DEC_MAX_LOG2) {
+        return false;
+    }
+
+    bool wasDisabled = IntMasterDisable();
+    ADCHardwareOversampleConfigure(ADC0_BASE, (hw == 1) ? 0 : hw);
+    avgHwFactor = hw;
+    avgDecLog2 = decLog2;
+    avgSum = 0;
+    avgCount = 0;
+    if (!wasDisabled) {
+        IntMasterEnable();
+    }
+    return true;
+}
+
+// Resposta ao comando "AVG": "AVG <hw> <dec> <Hz na saida> <bits efetivos>"
+static void AvgReport(void) {
+    char buffer[48];
+    FmtBuf f;
+
+    fmtInit(&f, buffer, sizeof(buffer));
+    fmtStr(&f, "AVG ");
+    fmtU32(&f, avgHwFactor);
+    fmtChar(&f, ' ');
+    fmtU32(&f, 1u << avgDecLog2);
+    fmtChar(&f, ' ');
+    fmtScaled(&f, ADC_SAMPLE_HZ, 1u << avgDecLog2, 2);
+    fmtChar(&f, ' ');
+    fmtFixed(&f, (int32_t)AvgEffectiveBitsTenths(), 1);
+    fmtStr(&f, "\r\n");
+    ChannelPrint(UART_CH_CTRL, buffer);
+}
+
+// --- Calibracao do sensor do cooler: contagens -> decimos de grau ---
+// Tabela de 4096 entradas montada pelo preprocessador (nada e calculado em
+// tempo de execucao): primeiro a correcao do ADC (offset e ganho medidos na
+// placa), depois a curva do sensor, reta de CAL_T0 a CAL_T0 + CAL_SPAN sobre a
+// escala inteira mais um arco (CAL_BOW, zero nas pontas) para linearizar.
+// Com os valores padrao 1024/2048/3072 contagens caem em 25/30/35 graus,
+// os limiares do diagrama de estados (sm.jpg).
+#define CAL_OFFSET_COUNTS 0    // Leitura com a entrada em 0 V
+#define CAL_GAIN_NUM      4096 // Ganho = NUM / DEN
+#define CAL_GAIN_DEN      4096
+#define CAL_T0_TENTHS     200  // Temperatura em 0 contagens
+#define CAL_SPAN_TENTHS   200  // Variacao sobre as 4096 contagens
+#define CAL_BOW_TENTHS    0    // Desvio no meio da escala (linearizacao)
+
+#define CAL_CLAMP(x)     ((x) < 0 ? 0 : (x) > 4095 ? 4095 : (x))
+#define CAL_COUNTS(n)    CAL_CLAMP((((int32_t)(n) - CAL_OFFSET_COUNTS) * CAL_GAIN_NUM) / CAL_GAIN_DEN)
+#define CAL_LINEAR(c)    ((int32_t)(c) * CAL_SPAN_TENTHS + 2048) / 4096
+#define CAL_ARC(c)       ((int64_t)CAL_BOW_TENTHS * 4 * (c) * (4096 - (c)) / (4096 * 4096))
+#define CAL_T(n)         (int16_t)(CAL_T0_TENTHS + CAL_LINEAR(CAL_COUNTS(n)) + CAL_ARC(CAL_COUNTS(n)))
+#define CAL_R4(n)        CAL_T(n), CAL_T((n) + 1), CAL_T((n) + 2), CAL_T((n) + 3)
+#define CAL_R16(n)       CAL_R4(n), CAL_R4((n) + 4), CAL_R4((n) + 8), CAL_R4((n) + 12)
+#define CAL_R64(n)       CAL_R16(n), CAL_R16((n) + 16), CAL_R16((n) + 32), CAL_R16((n) + 48)
+#define CAL_R256(n)      CAL_R64(n), CAL_R64((n) + 64), CAL_R64((n) + 128), CAL_R64((n) + 192)
+#define CAL_R1024(n)     CAL_R256(n), CAL_R256((n) + 256), CAL_R256((n) + 512), CAL_R256((n) + 768)
+
+static const int16_t calTempTenths[4096] = {
+    CAL_R1024(0), CAL_R1024(1024), CAL_R1024(2048), CAL_R1024(3072)
+};
+
+// Temperatura de uma leitura de 12 bits (uma consulta a tabela)
+static inline int32_t CalTempTenths(uint32_t counts) {
+    return calTempTenths[counts & 0x0FFF];
+}
+
+// Menor contagem com temperatura >= tenths (4096 se nenhuma). A tabela e
+// monotona; so e usada ao reprogramar os comparadores, fora do caminho da amostra.
+static uint32_t CalCountsAtLeast(int32_t tenths) {
+    uint32_t lo = 0, hi = 4096;
+    while (lo < hi) {
+        uint32_t mid = (lo + hi) / 2;
+        if (calTempTenths[mid] < tenths) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+// Resposta ao comando "CAL": "CAL <contagens> <graus>" do ultimo valor filtrado
+static void CalReport(void) {
+    char buffer[32];
+    FmtBuf f;
+    uint32_t counts = adcValue;
+
+    fmtInit(&f, buffer, sizeof(buffer));
+    fmtStr(&f, "CAL ");
+    fmtU32(&f, counts);
+    fmtChar(&f, ' ');
+    fmtFixed(&f, CalTempTenths(counts), 1);
+    fmtStr(&f, "\r\n");
+    ChannelPrint(UART_CH_CTRL, buffer);
+}
+
+// --- Estagio DSP em ponto fixo entre a aquisicao e o atuador ---
+// Com um filtro ativo a ISR junta DSP_BLOCK valores da media (escala de 16 bits)
+// e processa o bloco de uma vez; a saida filtrada vai para o streaming e
+// decide o estado do cooler (StateTrack) no lugar dos comparadores, que so
+// enxergam amostras brutas. Filtros:
+//   FIR    16 taps passa-baixas (Hamming, fc = 0,05 fs) em Q15 com SMLAD
+//   IIR    biquad Butterworth passa-baixas (fc = 0,02 fs) em Q31, forma direta I
+//   MED n  mediana movel de 3, 5 ou 7 amostras
+// Os ciclos de cada bloco sao medidos com o DWT.
+#define DSP_BLOCK      8
+#define DSP_FIR_TAPS   16 // Par: o SMLAD faz dois produtos por instrucao
+#define DSP_MEDIAN_MAX 7
+#define DSP_Q15_SHIFT  1  // Escala de 16 bits -> Q15 (0..32760)
+
+typedef enum {
+    DSP_NONE = 0,
+    DSP_FIR,
+    DSP_IIR,
+    DSP_MEDIAN
+} DspKind;
+
+static const char *const dspNames[] = { "OFF", "FIR", "IIR", "MED" };
+
+// Simetricos, entao a ordem invertida que o laco usa e a mesma. Soma = 32768 (ganho 1)
+static const int16_t firCoeffs[DSP_FIR_TAPS] = {
+    112, 243, 618, 1293, 2217, 3225, 4089, 4587,
+    4587, 4089, 3225, 2217, 1293, 618, 243, 112
+};
+
+// b0, b1, b2, a1, a2 em Q30 (|a1| > 1); y = b.x - a1*y1 - a2*y2
+static const int32_t iirCoeffs[5] = {
+    3888751, 7777502, 3888751, -1957103774, 898916953
+};
+
+volatile DspKind dspKind = DSP_NONE;
+uint32_t dspMedianLen = 5;
+int16_t dspIn[DSP_BLOCK];
+uint16_t dspOut[DSP_BLOCK]; // Saida de volta na escala de 16 bits
+uint32_t dspCount = 0;
+int16_t firState[DSP_FIR_TAPS - 1 + DSP_BLOCK]; // Historico + bloco atual
+int32_t iirState[4];                            // x1, x2, y1, y2 em Q31
+int16_t medianState[DSP_MEDIAN_MAX - 1 + DSP_BLOCK];
+uint32_t dspCyclesLast = 0;
+uint32_t dspCyclesMax = 0;
+uint32_t dspBlocks = 0;
+
+// Dois Q15 vizinhos numa palavra (LDR aceita endereco nao alinhado)
+static inline uint32_t Q15Pair(const int16_t *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static void DspFir(const int16_t *in, int16_t *out) {
+    memcpy(&firState[DSP_FIR_TAPS - 1], in, DSP_BLOCK * sizeof(int16_t));
+    for (uint32_t n = 0; n < DSP_BLOCK; n++) {
+        const int16_t *x = &firState[n];
+        int32_t acc = 0;
+        for (uint32_t k = 0; k < DSP_FIR_TAPS; k += 2) {
+            acc = (int32_t)__SMLAD(Q15Pair(&x[k]), Q15Pair(&firCoeffs[k]), (uint32_t)acc);
+        }
+        out[n] = (int16_t)__SSAT((acc + (1 << 14)) >> 15, 16);
+    }
+    memmove(firState, &firState[DSP_BLOCK], (DSP_FIR_TAPS - 1) * sizeof(int16_t));
+}
+
+static void DspIir(const int16_t *in, int16_t *out) {
+    int32_t x1 = iirState[0], x2 = iirState[1], y1 = iirState[2], y2 = iirState[3];
+    for (uint32_t n = 0; n < DSP_BLOCK; n++) {
+        int32_t x0 = (int32_t)in[n] << 16;
+        int64_t acc = (int64_t)iirCoeffs[0] * x0 + (int64_t)iirCoeffs[1] * x1
+                    + (int64_t)iirCoeffs[2] * x2 - (int64_t)iirCoeffs[3] * y1
+                    - (int64_t)iirCoeffs[4] * y2;
+        int64_t y = acc >> 30;
+        if (y > INT32_MAX) y = INT32_MAX;
+        if (y < INT32_MIN) y = INT32_MIN;
+        x2 = x1;
+        x1 = x0;
+        y2 = y1;
+        y1 = (int32_t)y;
+        out[n] = (int16_t)__SSAT((int32_t)((y + (1 << 15)) >> 16), 16); // Arredonda em 64 bits: y1 pode ser INT32_MAX
+    }
+    iirState[0] = x1;
+    iirState[1] = x2;
+    iirState[2] = y1;
+    iirState[3] = y2;
+}
+
+static void DspMedian(const int16_t *in, int16_t *out) {
+    uint32_t len = dspMedianLen;
+    memcpy(&medianState[DSP_MEDIAN_MAX - 1], in, DSP_BLOCK * sizeof(int16_t));
+    for (uint32_t n = 0; n < DSP_BLOCK; n++) {
+        int16_t window[DSP_MEDIAN_MAX];
+        const int16_t *x = &medianState[n + DSP_MEDIAN_MAX - len];
+        for (uint32_t i = 0; i < len; i++) { // Insercao: janela pequena
+            int16_t v = x[i];
+            uint32_t j = i;
+            while (j > 0 && window[j - 1] > v) {
+                window[j] = window[j - 1];
+                j--;
+            }
+            window[j] = v;
+        }
+        out[n] = window[len / 2];
+    }
+    memmove(medianState, &medianState[DSP_BLOCK], (DSP_MEDIAN_MAX - 1) * sizeof(int16_t));
+}
+
+// Acumula um valor na escala de 16 bits; com o bloco cheio processa e retorna true
+static bool DspPush(uint32_t sample16) {
+    int16_t out[DSP_BLOCK];
+
+    dspIn[dspCount++] = (int16_t)(sample16 >> DSP_Q15_SHIFT);
+    if (dspCount < DSP_BLOCK) {
+        return false;
+    }
+    dspCount = 0;
+
+    uint32_t start = CycleCounterGet();
+    switch (dspKind) {
+        case DSP_FIR:
+            DspFir(dspIn, out);
             break;
-        case STATE_LOW:
-            pulseWidth = (25 * load) / 100;
+        case DSP_IIR:
+            DspIir(dspIn, out);
             break;
-        case STATE_MEDIUM:
-            pulseWidth = (50 * load) / 100;
+        case DSP_MEDIAN:
+            DspMedian(dspIn, out);
             break;
-        case STATE_HIGH:
-            pulseWidth = (75 * load) / 100;
+        default:
+            memcpy(out, dspIn, sizeof(out));
             break;
     }
+    dspCyclesLast = CycleCounterGet() - start;
+    if (dspCyclesLast > dspCyclesMax) {
+        dspCyclesMax = dspCyclesLast;
+    }
+    dspBlocks++;
+
+    for (uint32_t n = 0; n < DSP_BLOCK; n++) {
+        int32_t v = (int32_t)out[n] << DSP_Q15_SHIFT;
+        dspOut[n] = (uint16_t)((v < 0) ? 0 : (v > 65520) ? 65520 : v);
+    }
+    return true;
+}
+
+// Historicos comecam no valor atual para nao gerar um degrau a partir de zero
+static bool DspConfigure(DspKind kind, uint32_t medianLen) {
+    if (kind == DSP_MEDIAN && (medianLen < 3 || medianLen > DSP_MEDIAN_MAX || !(medianLen & 1))) {
+        return false;
+    }
+
+    bool wasDisabled = IntMasterDisable();
+    int16_t x = (int16_t)(adcValue16 >> DSP_Q15_SHIFT);
+    for (uint32_t i = 0; i < DSP_FIR_TAPS - 1 + DSP_BLOCK; i++) {
+        firState[i] = x;
+    }
+    for (uint32_t i = 0; i < DSP_MEDIAN_MAX - 1 + DSP_BLOCK; i++) {
+        medianState[i] = x;
+    }
+    for (uint32_t i = 0; i < 4; i++) {
+        iirState[i] = (int32_t)x << 16;
+    }
+    dspCount = 0;
+    dspCyclesMax = 0;
+    dspBlocks = 0;
+    if (kind == DSP_MEDIAN) {
+        dspMedianLen = medianLen;
+    }
+    if (kind == DSP_NONE && dspKind != DSP_NONE) {
+        StateComparatorsSet(currentState); // Rearma os comparadores na faixa atual
+    }
+    dspKind = kind;
+    if (!wasDisabled) {
+        IntMasterEnable();
+    }
+    return true;
+}
+
+// Resposta ao comando "FILTER": "FILTER <tipo> <ciclos ultimo bloco> <ciclos max> <ciclos/amostra>"
+static void DspReport(void) {
+    char buffer[56];
+    FmtBuf f;
+
+    fmtInit(&f, buffer, sizeof(buffer));
+    fmtStr(&f, "FILTER ");
+    fmtStr(&f, dspNames[dspKind]);
+    if (dspKind == DSP_MEDIAN) {
+        fmtChar(&f, ' ');
+        fmtU32(&f, dspMedianLen);
+    }
+    fmtChar(&f, ' ');
+    fmtU32(&f, dspCyclesLast);
+    fmtChar(&f, ' ');
+    fmtU32(&f, dspCyclesMax);
+    fmtChar(&f, ' ');
+    fmtScaled(&f, dspCyclesLast, DSP_BLOCK, 1);
+    fmtStr(&f, "\r\n");
+    ChannelPrint(UART_CH_CTRL, buffer);
+}
+
+// --- PWM do cooler com atualizacao no fim do periodo ---
+// O gerador 2 roda em PWM_GEN_MODE_SYNC: escrever no CMPB nao muda a saida ate
+// o PWMSyncUpdate e a proxima passagem do contador por zero. Quem muda o duty
+// so enfileira a largura (PwmQueueWidth); a interrupcao de LOAD do gerador,
+// ligada apenas enquanto ha atualizacao pendente, aplica no inicio do periodo
+// seguinte e o valor vale a partir do fim dele. Nenhum pulso sai cortado e a
+// latencia e sempre de um a dois periodos do PWM, venha o pedido de onde vier.
+volatile uint32_t pwmWidth = 0; // Ultima largura pedida, em ticks do PWM
+
+static void PwmQueueWidth(uint32_t width) {
+    pwmWidth = width;
+    PWMGenIntTrigEnable(PWM0_BASE, PWM_GEN_2, PWM_INT_CNT_LOAD);
+}
+
+void PWMGen2IntHandler(void) {
+    PWMGenIntClear(PWM0_BASE, PWM_GEN_2, PWM_INT_CNT_LOAD);
+    PWMGenIntTrigDisable(PWM0_BASE, PWM_GEN_2, PWM_INT_CNT_LOAD); // Ate o proximo pedido
+    PWMPulseWidthSet(PWM0_BASE, PWM_OUT_5, pwmWidth);
+    PWMSyncUpdate(PWM0_BASE, PWM_GEN_2_BIT);
+}
+
+// --- Controle PID do cooler em ponto fixo ---
+// Roda na ISR do ADC sobre o mesmo valor que decide o estado: sem filtro a cada
+// novo valor da media (ADC_SAMPLE_HZ / 2^avgDecLog2), com filtro uma vez por
+// bloco do DSP, sobre a ultima saida filtrada (assim o ruido nao chega a
+// derivada). O periodo e o do Timer0 e nao depende do loop principal. Acao reversa:
+// erro = temperatura - setpoint (acima do setpoint, mais ventilacao).
+//   saida = Kp*e + I + Kd*(T - T anterior), em milesimos de duty (0..1000)
+// Ganhos em Q8 (256 = 1 milesimo de duty por decimo de grau, por passo no
+// Ki). Anti-windup: o integrador para quando a saida esta saturada no sentido
+// do erro e fica limitado a faixa da saida. A derivada usa a medida, nao o
+// erro, para uma troca de setpoint nao gerar um pico. Com o PID ligado os
+// estados so mudam os LEDs; o duty vem daqui.
+#define PID_Q            8
+#define PID_OUT_MAX      1000 // Milesimos de duty
+#define PID_SETPOINT_MIN 0
+#define PID_SETPOINT_MAX 1000 // 100,0 graus
+#define PID_GAIN_MAX     (1 << 14) // |Kp|, |Ki|, |Kd|. Com a temperatura em int16_t
+                                   // (|erro| < 2^15 + 1000, |dT| < 2^16) P + I + D
+                                   // fica abaixo de 1,7e9 e cabe em int32_t
+
+typedef struct {
+    int32_t setpoint; // Decimos de grau
+    int32_t kp;       // Q8
+    int32_t ki;
+    int32_t kd;
+    int32_t integral; // Q8, em milesimos de duty
+    int32_t lastTemp;
+    int32_t output;   // Milesimos de duty
+} Pid;
+
+volatile bool pidEnabled = false;
+Pid pid = { MEDIUM * 10, 20 << PID_Q, 5, 0, 0, 0, 0 }; // Banda proporcional de 5 graus, Ti ~ 10 s
+uint32_t pidCyclesLast = 0;   // Tempo de execucao do passo
+uint32_t pidCyclesMax = 0;
+uint32_t pidLastEntry = 0;    // DWT na entrada da ISR da execucao anterior
+uint32_t pidJitterMax = 0;    // Maior desvio do periodo esperado, em ciclos
+bool pidHasLast = false;
+uint32_t pidStepSamples = 1;  // Valores da media por passo (DSP_BLOCK com filtro)
+
+static int32_t PidClamp(int32_t v, int32_t lo, int32_t hi) {
+    return (v < lo) ? lo : (v > hi) ? hi : v;
+}
+
+// Um passo do controle; entry = DWT na entrada da ISR (para medir o jitter)
+static void PidStep(uint32_t entry, uint32_t counts) {
+    uint32_t start = CycleCounterGet();
+    int32_t temp = CalTempTenths(counts);
+
+    // Ligar ou desligar o filtro muda o periodo: recomeca a medida e a derivada
+    uint32_t samples = (dspKind == DSP_NONE) ? 1 : DSP_BLOCK;
+    if (samples != pidStepSamples) {
+        pidStepSamples = samples;
+        pidHasLast = false;
+    }
 
-    PWMPulseWidthSet(PWM0_BASE, PWM_OUT_5, pulseWidth);
+    if (pidHasLast) {
+        uint32_t expected = ((SysClock / ADC_SAMPLE_HZ) << avgDecLog2) * samples;
+        int32_t deviation = (int32_t)((entry - pidLastEntry) - expected);
+        uint32_t jitter = (deviation < 0) ? (uint32_t)-deviation : (uint32_t)deviation;
+        if (jitter > pidJitterMax) {
+            pidJitterMax = jitter;
+        }
+    } else {
+        pid.lastTemp = temp;
+    }
+    pidLastEntry = entry;
+    pidHasLast = true;
+
+    int32_t error = temp - pid.setpoint;
+    int32_t proportional = pid.kp * error;
+    int32_t derivative = pid.kd * (temp - pid.lastTemp);
+    int32_t integral = PidClamp(pid.integral + pid.ki * error, 0, PID_OUT_MAX << PID_Q);
+    int32_t unclamped = (proportional + integral + derivative) >> PID_Q;
+    pid.lastTemp = temp;
+
+    // Anti-windup: so integra se a saida nao estiver presa no sentido do erro
+    if (!((unclamped >= PID_OUT_MAX && error > 0) || (unclamped <= 0 && error < 0))) {
+        pid.integral = integral;
+    }
+    pid.output = PidClamp(unclamped, 0, PID_OUT_MAX);
+
+    uint32_t load = PWMGenPeriodGet(PWM0_BASE, PWM_GEN_2);
+    PwmQueueWidth(((uint32_t)pid.output * load) / PID_OUT_MAX);
+
+    pidCyclesLast = CycleCounterGet() - start;
+    if (pidCyclesLast > pidCyclesMax) {
+        pidCyclesMax = pidCyclesLast;
+    }
+}
+
+// Liga/desliga; ao ligar o integrador parte do duty atual (sem tranco)
+static void PidEnable(bool enable) {
+    bool wasDisabled = IntMasterDisable();
+    if (enable && !pidEnabled) {
+        uint32_t load = PWMGenPeriodGet(PWM0_BASE, PWM_GEN_2);
+        uint32_t duty = (pwmWidth * PID_OUT_MAX) / load;
+        pid.integral = (int32_t)duty << PID_Q;
+        pidHasLast = false;
+        pidCyclesMax = 0;
+        pidJitterMax = 0;
+    }
+    pidEnabled = enable;
+    if (!wasDisabled) {
+        IntMasterEnable();
+    }
+}
+
+// Decimos de grau a partir de "27" ou "27.5"
+static bool ParseTenths(const char *text, int32_t *tenths) {
+    char *end;
+    int32_t value = (int32_t)strtol(text, &end, 10) * 10;
+    if (end == text) {
+        return false;
+    }
+    if (*end == '.' && end[1] >= '0' && end[1] <= '9') {
+        value += (text[0] == '-') ? -(end[1] - '0') : (end[1] - '0');
+    }
+    *tenths = value;
+    return true;
+}
+
+// Um ganho de "PID K" em Q8; end aponta para depois do numero
+static bool ParseGain(const char *text, char **end, int32_t *gain) {
+    long value = strtol(text, end, 10);
+    if (*end == text || value < -PID_GAIN_MAX || value > PID_GAIN_MAX) {
+        return false;
+    }
+    *gain = (int32_t)value;
+    return true;
+}
+
+// Resposta ao comando "PID" em duas linhas (cada mensagem cabe num quadro):
+// "PID <ON|OFF> <setpoint> <kp> <ki> <kd> <duty %>"
+// "PIDT <ciclos> <ciclos max> <jitter max em us>"
+static void PidReport(void) {
+    char buffer[56];
+    FmtBuf f;
+
+    fmtInit(&f, buffer, sizeof(buffer));
+    fmtStr(&f, pidEnabled ? "PID ON " : "PID OFF ");
+    fmtFixed(&f, pid.setpoint, 1);
+    fmtChar(&f, ' ');
+    fmtI32(&f, pid.kp);
+    fmtChar(&f, ' ');
+    fmtI32(&f, pid.ki);
+    fmtChar(&f, ' ');
+    fmtI32(&f, pid.kd);
+    fmtChar(&f, ' ');
+    fmtFixed(&f, pid.output, 1);
+    fmtStr(&f, "\r\n");
+    ChannelPrint(UART_CH_CTRL, buffer);
+
+    fmtInit(&f, buffer, sizeof(buffer));
+    fmtStr(&f, "PIDT ");
+    fmtU32(&f, pidCyclesLast);
+    fmtChar(&f, ' ');
+    fmtU32(&f, pidCyclesMax);
+    fmtChar(&f, ' ');
+    fmtScaled(&f, pidJitterMax, SysClock / 1000000, 2);
+    fmtStr(&f, "\r\n");
+    ChannelPrint(UART_CH_CTRL, buffer);
+}
+
+// --- Curva ADC -> duty em malha aberta (tabela, histerese e limite de rampa) ---
+// "CURVE SET c:d ..." descreve ate CURVE_POINTS_MAX pontos (contagens:duty em
+// %, contagens crescentes) e o loop principal gera uma tabela de 257 entradas
+// ja em ticks do PWM. A ISR so interpola entre duas entradas (indice = 8 bits
+// de cima, fracao = 4 de baixo), sem divisao nem PWMGenPeriodGet. A entrada so
+// muda quando anda mais que curveHyst contagens e o duty anda no maximo
+// curveSlew milesimos por passo. Com filtro ativo a entrada e a saida do
+// estagio DSP, um passo por bloco (como no PID). A tabela nova e montada no buffer que a ISR
+// nao esta lendo e trocada de uma vez.
+#define CURVE_POINTS_MAX 8
+#define CURVE_TABLE_SIZE 257
+#define CURVE_FRAC_BITS  4
+#define CURVE_HYST_MAX   512 // Contagens; acima disso a curva quase nao reage
+
+// "CURVE SET" + CURVE_POINTS_MAX * " 4095:100" precisa caber com o '\0'
+#if (9 + CURVE_POINTS_MAX * 9) >= CMD_BUFFER_SIZE
+#error "CMD_BUFFER_SIZE pequeno para um CURVE SET completo"
+#endif
+
+typedef struct {
+    uint16_t counts;
+    uint8_t dutyPct;
+} CurvePoint;
+
+volatile bool curveEnabled = false;
+CurvePoint curvePoints[CURVE_POINTS_MAX] = {
+    { 0, 0 }, { 1024, 25 }, { 2048, 50 }, { 3072, 75 }, { 4095, 100 }
+};
+uint32_t curvePointCount = 5;
+uint16_t curveTables[2][CURVE_TABLE_SIZE];
+const uint16_t *volatile curveTable = curveTables[0];
+uint32_t curveHyst = 16;      // Contagens
+uint32_t curveSlew = 20;      // Milesimos de duty por amostra
+uint32_t curveSlewTicks = 0;  // curveSlew ja em ticks do PWM
+uint32_t curveInput = 0;      // Ultima entrada aceita pela histerese
+uint32_t curveDuty = 0;       // Ticks aplicados no PWM
+
+// Duty (em ticks) da curva por partes em uma contagem
+static uint32_t CurveEval(uint32_t counts, uint32_t load) {
+    const CurvePoint *p = curvePoints;
+    if (counts <= p[0].counts) {
+        return (p[0].dutyPct * load) / 100;
+    }
+    for (uint32_t i = 1; i < curvePointCount; i++) {
+        if (counts <= p[i].counts) {
+            uint32_t span = p[i].counts - p[i - 1].counts;
+            int32_t d0 = (int32_t)(p[i - 1].dutyPct * load);
+            int32_t d1 = (int32_t)(p[i].dutyPct * load);
+            int32_t d = d0 + (d1 - d0) * (int32_t)(counts - p[i - 1].counts) / (int32_t)span;
+            return (uint32_t)d / 100;
+        }
+    }
+    return (p[curvePointCount - 1].dutyPct * load) / 100;
+}
+
+// Gera a tabela no buffer livre e troca (chamada fora da ISR)
+static void CurveRebuild(void) {
+    uint32_t load = PWMGenPeriodGet(PWM0_BASE, PWM_GEN_2);
+    uint16_t *table = (curveTable == curveTables[0]) ? curveTables[1] : curveTables[0];
+
+    for (uint32_t i = 0; i < CURVE_TABLE_SIZE; i++) {
+        uint32_t counts = i << CURVE_FRAC_BITS;
+        table[i] = (uint16_t)CurveEval((counts > 4095) ? 4095 : counts, load);
+    }
+    bool wasDisabled = IntMasterDisable();
+    curveTable = table;
+    curveSlewTicks = (curveSlew * load) / 1000;
+    if (curveSlewTicks == 0) {
+        curveSlewTicks = 1;
+    }
+    if (!wasDisabled) {
+        IntMasterEnable();
+    }
+}
+
+// Um passo na ISR do ADC
+static void CurveStep(uint32_t counts) {
+    if (counts + curveHyst < curveInput || counts > curveInput + curveHyst) {
+        curveInput = counts;
+    }
+
+    const uint16_t *t = curveTable;
+    uint32_t i = curveInput >> CURVE_FRAC_BITS;
+    uint32_t frac = curveInput & ((1u << CURVE_FRAC_BITS) - 1);
+    int32_t target = t[i] + (((int32_t)t[i + 1] - t[i]) * (int32_t)frac >> CURVE_FRAC_BITS);
+
+    int32_t step = target - (int32_t)curveDuty;
+    if (step > (int32_t)curveSlewTicks) {
+        step = (int32_t)curveSlewTicks;
+    } else if (step < -(int32_t)curveSlewTicks) {
+        step = -(int32_t)curveSlewTicks;
+    }
+    curveDuty += step;
+    PwmQueueWidth(curveDuty);
+}
+
+// Pontos "c:d" separados por espaco; contagens crescentes ate 4095, duty ate 100
+static bool CurveParse(const char *text) {
+    CurvePoint points[CURVE_POINTS_MAX];
+    uint32_t count = 0;
+    char *end;
+
+    while (*text) {
+        while (*text == ' ') text++;
+        if (!*text) break;
+        if (count == CURVE_POINTS_MAX) return false;
+        uint32_t counts = strtoul(text, &end, 10);
+        if (end == text || *end != ':') return false;
+        text = end + 1;
+        uint32_t duty = strtoul(text, &end, 10);
+        if (end == text || counts > 4095 || duty > 100) return false;
+        if (count > 0 && counts <= points[count - 1].counts) return false;
+        points[count].counts = (uint16_t)counts;
+        points[count].dutyPct = (uint8_t)duty;
+        count++;
+        text = end;
+    }
+    if (count < 2) {
+        return false;
+    }
+    memcpy(curvePoints, points, count * sizeof(CurvePoint));
+    curvePointCount = count;
+    return true;
+}
+
+// Liga/desliga; ao ligar a rampa parte do duty atual
+static void CurveEnable(bool enable) {
+    bool wasDisabled = IntMasterDisable();
+    if (enable && !curveEnabled) {
+        curveDuty = pwmWidth;
+        curveInput = adcValue;
+    }
+    curveEnabled = enable;
+    if (!wasDisabled) {
+        IntMasterEnable();
+    }
 }
 
+// Resposta ao comando "CURVE": "CURVE <ON|OFF> <pontos> <histerese> <rampa> <duty %>"
+static void CurveReport(void) {
+    char buffer[48];
+    FmtBuf f;
 
+    fmtInit(&f, buffer, sizeof(buffer));
+    fmtStr(&f, curveEnabled ? "CURVE ON " : "CURVE OFF ");
+    fmtU32(&f, curvePointCount);
+    fmtChar(&f, ' ');
+    fmtU32(&f, curveHyst);
+    fmtChar(&f, ' ');
+    fmtU32(&f, curveSlew);
+    fmtChar(&f, ' ');
+    fmtScaled(&f, (uint64_t)curveDuty * 100, PWMGenPeriodGet(PWM0_BASE, PWM_GEN_2), 1);
+    fmtStr(&f, "\r\n");
+    ChannelPrint(UART_CH_CTRL, buffer);
+}
+
+// --- Tacometro do cooler: captura do tempo de borda no Timer1A ---
+// O tach do cooler (coletor aberto, TACH_PULSES_PER_REV pulsos por volta)
+// entra no PD2 (T1CCP0) com pull-up interno. O Timer1A conta para cima em 24
+// bits (16 + prescaler de 8) no SysClock e o hardware copia o contador em cada
+// borda de subida, entao o periodo nao depende da latencia da ISR. A 120 MHz o
+// contador volta a zero a cada ~140 ms: cada estouro (TIMEOUT) soma 2^24 a
+// parte alta do tempo, e periodos maiores que uma volta do contador tambem
+// saem certos. Sem borda por TACH_STALL_WRAPS estouros o RPM vai a zero e, com
+// o PWM ligado, o cooler e dado como parado (aviso no canal LOG, sem polling).
+// O RPM sai da mediana dos ultimos TACH_MEDIAN_SIZE periodos, que descarta
+// um pulso perdido ou duplicado; bordas mais rapidas que TACH_RPM_MAX sao
+// repique e sao ignoradas.
+#define TACH_PULSES_PER_REV   2
+#define TACH_COUNTER_BITS     24
+#define TACH_COUNTER_MASK     ((1u << TACH_COUNTER_BITS) - 1)
+#define TACH_MEDIAN_SIZE      5
+#define TACH_STALL_WRAPS      8     // ~1,1 s sem borda a 120 MHz
+#define TACH_RPM_MAX          20000
+#define TACH_TELEMETRY_TICKS  50    // "TEL" no canal LOG a 2 Hz com o Timer0 a 100 Hz
+
+volatile uint32_t tachRpm = 0;
+volatile uint32_t tachPeriod = 0;   // Mediana, em ciclos do SysClock
+volatile uint32_t tachEdges = 0;
+volatile bool tachStalled = false;
+uint32_t tachRpmNum = 0;            // 60 * SysClock / pulsos por volta
+uint32_t tachMinPeriod = 0;
+uint32_t tachHigh = 0;              // Parte alta do tempo (multiplos de 2^24)
+uint32_t tachLast = 0;
+bool tachHasLast = false;
+uint32_t tachWraps = 0;             // Estouros desde a ultima borda
+uint32_t tachPeriods[TACH_MEDIAN_SIZE];
+uint32_t tachCount = 0;
+uint32_t tachIdx = 0;
+
+static uint32_t TachMedian(void) {
+    uint32_t sorted[TACH_MEDIAN_SIZE];
+    for (uint32_t i = 0; i < tachCount; i++) {
+        uint32_t v = tachPeriods[i];
+        uint32_t j = i;
+        for (; j > 0 && sorted[j - 1] > v; j--) {
+            sorted[j] = sorted[j - 1];
+        }
+        sorted[j] = v;
+    }
+    return sorted[tachCount / 2];
+}
+
+static void TachEdge(uint32_t now) {
+    tachWraps = 0;
+    if (tachHasLast) {
+        uint32_t period = now - tachLast; // Modular: vale mesmo com a parte alta dando a volta
+        if (period < tachMinPeriod) {
+            return; // Repique: mantem a borda de referencia
+        }
+        tachPeriods[tachIdx] = period;
+        tachIdx = (tachIdx + 1) % TACH_MEDIAN_SIZE;
+        if (tachCount < TACH_MEDIAN_SIZE) {
+            tachCount++;
+        }
+        tachPeriod = TachMedian();
+        tachRpm = tachRpmNum / tachPeriod;
+        tachEdges++;
+    }
+    tachLast = now;
+    tachHasLast = true;
+    if (tachStalled) {
+        tachStalled = false;
+        ChannelPrint(UART_CH_LOG, "TACH OK\r\n");
+    }
+}
+
+static void TachWrap(void) {
+    if (pwmWidth == 0 && tachRpm == 0) {
+        tachWraps = 0; // Desligado e parado: a contagem recomeca quando o PWM ligar
+        tachStalled = false;
+        return;
+    }
+    if (++tachWraps < TACH_STALL_WRAPS) {
+        return;
+    }
+    tachWraps = 0;
+    tachHasLast = false;
+    tachCount = 0;
+    tachIdx = 0;
+    tachRpm = 0;
+    tachPeriod = 0;
+    if (pwmWidth != 0 && !tachStalled) {
+        tachStalled = true;
+        ChannelPrint(UART_CH_LOG, "TACH PARADO\r\n");
+    }
+}
+
+// Captura e estouro chegam pela mesma ISR. Se os dois estao pendentes, uma
+// captura na metade baixa do contador foi feita depois do estouro.
+void Timer1AIntHandler(void) {
+    uint32_t status = TimerIntStatus(TIMER1_BASE, true);
+    TimerIntClear(TIMER1_BASE, status);
+    bool wrapped = (status & TIMER_TIMA_TIMEOUT) != 0;
+
+    if (status & TIMER_CAPA_EVENT) {
+        uint32_t capture = TimerValueGet(TIMER1_BASE, TIMER_A) & TACH_COUNTER_MASK;
+        if (wrapped && capture < (TACH_COUNTER_MASK >> 1)) {
+            tachHigh += 1u << TACH_COUNTER_BITS;
+            wrapped = false;
+        }
+        TachEdge(tachHigh | capture);
+    }
+    if (wrapped) {
+        tachHigh += 1u << TACH_COUNTER_BITS;
+        TachWrap();
+    }
+}
+
+// Linha periodica no canal LOG: "TEL <graus> <rpm> <duty %>"
+static void TachTelemetry(void) {
+    char buffer[40];
+    FmtBuf f;
+
+    fmtInit(&f, buffer, sizeof(buffer));
+    fmtStr(&f, "TEL ");
+    fmtFixed(&f, CalTempTenths(adcValue), 1);
+    fmtChar(&f, ' ');
+    fmtU32(&f, tachRpm);
+    fmtChar(&f, ' ');
+    fmtScaled(&f, (uint64_t)pwmWidth * 100, PWMGenPeriodGet(PWM0_BASE, PWM_GEN_2), 1);
+    fmtStr(&f, "\r\n");
+    ChannelPrint(UART_CH_LOG, buffer);
+}
+
+// Resposta ao comando "TACH": "TACH <rpm> <periodo us> <bordas> <OK|PARADO>"
+static void TachReport(void) {
+    char buffer[48];
+    FmtBuf f;
+
+    fmtInit(&f, buffer, sizeof(buffer));
+    fmtStr(&f, "TACH ");
+    fmtU32(&f, tachRpm);
+    fmtChar(&f, ' ');
+    fmtScaled(&f, tachPeriod, SysClock / 1000000, 0);
+    fmtChar(&f, ' ');
+    fmtU32(&f, tachEdges);
+    fmtStr(&f, tachStalled ? " PARADO\r\n" : " OK\r\n");
+    ChannelPrint(UART_CH_CTRL, buffer);
+}
+
+// Resposta a um comando pelo canal CTRL: texto e "\r\n"
+static void CommandReply(const char *text, uint32_t value, bool hasValue) {
+    char buffer[40];
+    FmtBuf f;
+
+    fmtInit(&f, buffer, sizeof(buffer));
+    fmtStr(&f, text);
+    if (hasValue) {
+        fmtChar(&f, ' ');
+        fmtU32(&f, value);
+    }
+    fmtStr(&f, "\r\n");
+    ChannelPrint(UART_CH_CTRL, buffer);
+}
+
+// --- Negociacao do baud rate em tempo de execucao ---
+// 1. Host envia "BAUD <taxa>"; a placa pausa o streaming, responde "ACK <taxa>"
+//    na taxa antiga, espera o TX esvaziar e troca para a nova taxa.
+// 2. Host troca tambem e envia "SYNC"; a placa confirma com "SYNC OK <taxa>"
+//    e retoma o streaming.
+// 3. Sem SYNC dentro de BAUD_SYNC_TIMEOUT_TICKS a placa volta para a taxa
+//    anterior e avisa com "BAUD FALLBACK <taxa>". O host faz o mesmo se nao
+//    receber o "SYNC OK".
+#define BAUD_DEFAULT 115200
+#define BAUD_MIN     9600
+#define BAUD_SYNC_TIMEOUT_TICKS 100 // 1 s com o Timer0 a 100 Hz
+
+typedef enum {
+    BAUD_IDLE = 0,
+    BAUD_WAIT_SYNC
+} BaudState;
+
+BaudState baudState = BAUD_IDLE;
+uint32_t uartBaud = BAUD_DEFAULT;
+uint32_t uartBaudPrevious = BAUD_DEFAULT;
+uint32_t baudDeadline = 0;
+volatile uint32_t timerTicks = 0; // Incrementado a cada amostra do ADC
+
+// Maior taxa aceita: UART0 roda do SysClock e com HSE divide por 8
+static uint32_t BaudMax(void) {
+    return SysClock / 8;
+}
+
+// Troca a taxa depois que tudo que ja foi enfileirado saiu na taxa atual
+static void UARTSetBaud(uint32_t baud) {
+    while (UARTTxPending() || UARTBusy(UART0_BASE));
+
+    bool wasDisabled = IntMasterDisable();
+    UARTConfigSetExpClk(UART0_BASE, SysClock, baud,
+        (UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE));
+    uartBaud = baud;
+    cmdIndex = 0; // Bytes recebidos durante a troca sao lixo
+    cmdOverflow = false;
+    if (!wasDisabled) {
+        IntMasterEnable();
+    }
+}
+
+// Chamada no loop principal: desfaz a troca se o SYNC nao chegou a tempo
+void BaudPoll(void) {
+    if (baudState == BAUD_WAIT_SYNC && (int32_t)(timerTicks - baudDeadline) >= 0) {
+        UARTSetBaud(uartBaudPrevious);
+        baudState = BAUD_IDLE;
+        streamPaused = false;
+        CommandReply("BAUD FALLBACK", uartBaud, true);
+    }
+}
+
+// Trata a linha recebida pela UART (chamada no loop principal, fora da ISR).
+// Comandos: "MODE ASCII", "MODE BIN", "MODE ASCII16", "BAUD <taxa>", "SYNC",
+// "MUX ON", "MUX OFF", "SUB <mascara>" (bit 0 CTRL, 1 LOG, 2 DATA), "SCAN",
+// "AVG [<hw> <dec>]" (oversampling do hardware e decimacao) e
+// "FILTER [OFF|FIR|IIR|MED <n>]" (estagio DSP), "CAL" (leitura em graus) e
+// "PID [ON|OFF|SP <graus>|K <kp> <ki> <kd>]" (controle do cooler) e
+// "CURVE [ON|OFF|SET c:d ...|HYST <n>|SLEW <n>]" (curva em malha aberta).
+void ProcessCommand(const char *cmd) {
+    if (baudState == BAUD_WAIT_SYNC) {
+        // Ate o link ser confirmado qualquer outra linha e lixo da troca de taxa
+        if (strcmp(cmd, "SYNC") == 0) {
+            baudState = BAUD_IDLE;
+            streamPaused = false;
+            CommandReply("SYNC OK", uartBaud, true);
+        }
+        return;
+    }
+
+    if (strcmp(cmd, "MODE ASCII") == 0) {
+        StreamSetMode(STREAM_ASCII);
+        CommandReply("OK", 0, false);
+    } else if (strcmp(cmd, "MODE BIN") == 0) {
+        StreamSetMode(STREAM_BINARY);
+        CommandReply("OK", 0, false);
+    } else if (strcmp(cmd, "MODE ASCII16") == 0) {
+        StreamSetMode(STREAM_ASCII16);
+        CommandReply("OK", 0, false);
+    } else if (strncmp(cmd, "BAUD ", 5) == 0) {
+        uint32_t baud = strtoul(cmd + 5, NULL, 10);
+        if (baud < BAUD_MIN || baud > BaudMax()) {
+            CommandReply("ERR", 0, false);
+            return;
+        }
+        streamPaused = true;
+        CommandReply("ACK", baud, true);
+        uartBaudPrevious = uartBaud;
+        UARTSetBaud(baud);
+        baudDeadline = timerTicks + BAUD_SYNC_TIMEOUT_TICKS;
+        baudState = BAUD_WAIT_SYNC;
+    } else if (strcmp(cmd, "SYNC") == 0) {
+        // Host conferindo o link sem troca pendente
+        CommandReply("SYNC OK", uartBaud, true);
+    } else if (strcmp(cmd, "MUX ON") == 0 || strcmp(cmd, "MUX OFF") == 0) {
+        // Mensagens ja enfileiradas saem no formato antigo; o host se
+        // sincroniza no proximo 0x00
+        uartMuxEnabled = (cmd[5] == 'N');
+        CommandReply("OK", 0, false);
+    } else if (strncmp(cmd, "SUB ", 4) == 0) {
+        uartChSubscribed = (strtoul(cmd + 4, NULL, 0) & ((1u << UART_CH_COUNT) - 1)) | (1u << UART_CH_CTRL);
+        CommandReply("SUB", uartChSubscribed, true);
+    } else if (strcmp(cmd, "SCAN") == 0) {
+        ScanReport();
+    } else if (strcmp(cmd, "AVG") == 0) {
+        AvgReport();
+    } else if (strncmp(cmd, "AVG ", 4) == 0) {
+        char *end;
+        uint32_t hw = strtoul(cmd + 4, &end, 10);
+        uint32_t dec = strtoul(end, NULL, 10);
+        if (AvgConfigure(hw, dec)) {
+            AvgReport();
+        } else {
+            CommandReply("ERR", 0, false);
+        }
+    } else if (strcmp(cmd, "CAL") == 0) {
+        CalReport();
+    } else if (strcmp(cmd, "PID") == 0) {
+        PidReport();
+    } else if (strcmp(cmd, "PID ON") == 0 || strcmp(cmd, "PID OFF") == 0) {
+        CurveEnable(false);
+        PidEnable(cmd[5] == 'N');
+        if (!pidEnabled) {
+            StateDutySet(currentState); // Volta ao duty fixo do estado
+        }
+        PidReport();
+    } else if (strncmp(cmd, "PID SP ", 7) == 0) {
+        int32_t setpoint;
+        if (ParseTenths(cmd + 7, &setpoint) && setpoint >= PID_SETPOINT_MIN && setpoint <= PID_SETPOINT_MAX) {
+            pid.setpoint = setpoint;
+            PidReport();
+        } else {
+            CommandReply("ERR", 0, false);
+        }
+    } else if (strncmp(cmd, "PID K ", 6) == 0) {
+        // Ganho fora da faixa estouraria o int32_t do PidStep dentro da ISR
+        char *end;
+        int32_t kp, ki, kd;
+        if (ParseGain(cmd + 6, &end, &kp) && ParseGain(end, &end, &ki) &&
+            ParseGain(end, &end, &kd) && *end == '\0') {
+            bool wasDisabled = IntMasterDisable();
+            pid.kp = kp;
+            pid.ki = ki;
+            pid.kd = kd;
+            if (!wasDisabled) {
+                IntMasterEnable();
+            }
+            PidReport();
+        } else {
+            CommandReply("ERR", 0, false);
+        }
+    } else if (strcmp(cmd, "CURVE") == 0) {
+        CurveReport();
+    } else if (strcmp(cmd, "CURVE ON") == 0 || strcmp(cmd, "CURVE OFF") == 0) {
+        PidEnable(false);
+        CurveEnable(cmd[7] == 'N');
+        if (!curveEnabled) {
+            StateDutySet(currentState); // Volta ao duty fixo do estado
+        }
+        CurveReport();
+    } else if (strncmp(cmd, "CURVE SET ", 10) == 0) {
+        if (CurveParse(cmd + 10)) {
+            CurveRebuild();
+            CurveReport();
+        } else {
+            CommandReply("ERR", 0, false);
+        }
+    } else if (strncmp(cmd, "CURVE HYST ", 11) == 0) {
+        char *end;
+        uint32_t hyst = strtoul(cmd + 11, &end, 10);
+        if (end != cmd + 11 && *end == '\0' && hyst <= CURVE_HYST_MAX) {
+            curveHyst = hyst;
+            CurveReport();
+        } else {
+            CommandReply("ERR", 0, false);
+        }
+    } else if (strncmp(cmd, "CURVE SLEW ", 11) == 0) {
+        uint32_t slew = strtoul(cmd + 11, NULL, 10);
+        if (slew >= 1 && slew <= 1000) {
+            curveSlew = slew;
+            CurveRebuild();
+            CurveReport();
+        } else {
+            CommandReply("ERR", 0, false);
+        }
+    } else if (strcmp(cmd, "TACH") == 0) {
+        TachReport();
+    } else if (strcmp(cmd, "FILTER") == 0) {
+        DspReport();
+    } else if (strncmp(cmd, "FILTER ", 7) == 0) {
+        const char *arg = cmd + 7;
+        bool ok = false;
+        if (strcmp(arg, "OFF") == 0) {
+            ok = DspConfigure(DSP_NONE, 0);
+        } else if (strcmp(arg, "FIR") == 0) {
+            ok = DspConfigure(DSP_FIR, 0);
+        } else if (strcmp(arg, "IIR") == 0) {
+            ok = DspConfigure(DSP_IIR, 0);
+        } else if (strncmp(arg, "MED ", 4) == 0) {
+            ok = DspConfigure(DSP_MEDIAN, strtoul(arg + 4, NULL, 10));
+        }
+        if (ok) {
+            DspReport();
+        } else {
+            CommandReply("ERR", 0, false);
+        }
+    } else {
+        CommandReply("ERR", 0, false);
+    }
+}
+
+// --- Classificacao do cooler pelos comparadores digitais do ADC ---
+// O seq1 tem dois passos extras sobre AIN9, um para cada comparador, e o
+// mesmo gatilho do Timer0. CMP0 dispara quando o valor cai abaixo da faixa do
+// estado atual e CMP1 quando passa acima dela, cada um com STATE_HYSTERESIS
+// decimos de grau de folga. A interrupcao do seq1 so chega numa transicao; ela
+// anda um estado na direcao do comparador e reprograma as faixas para o novo
+// estado (um salto grande atravessa uma faixa por amostra). As faixas sao em
+// graus e viram contagens pela tabela de calibracao.
+#define CMP_SEQUENCER    1
+#define CMP_DOWN         0 // Comparador 0: abaixo da faixa
+#define CMP_UP           1 // Comparador 1: acima da faixa
+#define STATE_HYSTERESIS 2 // 0,2 grau
+
+typedef struct {
+    int16_t low;       // Faixa do estado em decimos de grau: [low, high)
+    int16_t high;
+    uint8_t dutyPct;   // PWM do cooler
+    uint8_t leds;
+    const char *name;
+} StateBand;
+
+static const StateBand stateTable[] = {
+    [STATE_INIT]   = { INT16_MIN,   INT16_MIN,   0,  LEDS_ON_1,   "INIT" },
+    [STATE_OFF]    = { INT16_MIN,   LOW * 10,    0,  LEDS_ON_1,   "DESLIGADO" },
+    [STATE_LOW]    = { LOW * 10,    MEDIUM * 10, 25, LEDS_ON_12,  "FRACO" },
+    [STATE_MEDIUM] = { MEDIUM * 10, HIGH * 10,   50, LEDS_ON_123, "MEDIO" },
+    [STATE_HIGH]   = { HIGH * 10,   INT16_MAX,   75, LEDS_ON_ALL, "FORTE" },
+};
+
+volatile uint32_t stateTransitions = 0;
+
+void StateComparatorsSet(State s) {
+    const StateBand *band = &stateTable[s];
+    uint32_t down = CalCountsAtLeast((int32_t)band->low - STATE_HYSTERESIS);
+    uint32_t up = CalCountsAtLeast((int32_t)band->high + STATE_HYSTERESIS);
+    if (up > 4095) {
+        up = 4095; // No ultimo estado a subida e ignorada
+    }
+
+    // Regiao baixa: valor < referencia baixa; regiao alta: valor >= referencia alta
+    ADCComparatorRegionSet(ADC0_BASE, CMP_DOWN, down, down);
+    ADCComparatorRegionSet(ADC0_BASE, CMP_UP, up, up);
+    ADCComparatorReset(ADC0_BASE, CMP_DOWN, true, true);
+    ADCComparatorReset(ADC0_BASE, CMP_UP, true, true);
+}
+
+// Duty fixo do estado (sem o PID)
+void StateDutySet(State s) {
+    uint32_t load = PWMGenPeriodGet(PWM0_BASE, PWM_GEN_2);
+    PwmQueueWidth((stateTable[s].dutyPct * load) / 100);
+}
+
+// Aplica um estado: faixas dos comparadores, PWM, LEDs e aviso no canal LOG
+void StateApply(State s) {
+    char buffer[24];
+    FmtBuf f;
+
+    currentState = s;
+    stateTransitions++;
+    StateComparatorsSet(s);
+
+    if (!pidEnabled && !curveEnabled) {
+        StateDutySet(s);
+    }
+    ledsOn(stateTable[s].leds);
+
+    fmtInit(&f, buffer, sizeof(buffer));
+    fmtStr(&f, "ESTADO ");
+    fmtStr(&f, stateTable[s].name);
+    fmtStr(&f, "\r\n");
+    ChannelPrint(UART_CH_LOG, buffer);
+}
+
+// Mesmas faixas e histerese dos comparadores, aplicadas a saida do estagio DSP
+static void StateTrack(uint32_t value) {
+    int32_t temp = CalTempTenths(value);
+    State next = currentState;
+    while (next > STATE_OFF && temp < stateTable[next].low - STATE_HYSTERESIS) {
+        next = (State)(next - 1);
+    }
+    while (next < STATE_HIGH && temp >= stateTable[next].high + STATE_HYSTERESIS) {
+        next = (State)(next + 1);
+    }
+    if (next != currentState) {
+        StateApply(next);
+    }
+}
+
+// So roda quando um comparador detecta que o valor saiu da faixa do estado
+void ADC0Seq1IntHandler(void) {
+    uint32_t status = ADCComparatorIntStatus(ADC0_BASE);
+    ADCComparatorIntClear(ADC0_BASE, status);
+    ADCIntClearEx(ADC0_BASE, ADC_INT_DCON_SS1);
+    if (dspKind != DSP_NONE) {
+        return; // Com filtro ativo o estado vem da saida do estagio DSP
+    }
+
+    State next = currentState;
+    if ((status & (1u << CMP_DOWN)) && currentState > STATE_OFF) {
+        next = (State)(currentState - 1);
+    } else if ((status & (1u << CMP_UP)) && currentState < STATE_HIGH) {
+        next = (State)(currentState + 1);
+    }
+    if (next != currentState) {
+        StateApply(next);
+    }
+}
+
+// PID ou curva (ligar um desliga o outro) sobre o valor ja filtrado
+static void ControlStep(uint32_t entry, uint32_t counts) {
+    if (pidEnabled) {
+        PidStep(entry, counts);
+    } else if (curveEnabled) {
+        CurveStep(counts);
+    }
+}
+
+// Fim da varredura disparada pelo Timer0 (nenhuma espera ativa)
+void ADC0Seq0IntHandler(void) {
+    uint32_t entry = CycleCounterGet();
+    ADCIntClear(ADC0_BASE, ADC_SEQUENCER);
+    uint32_t raw = ScanCollect()->raw[SCAN_IDX_COOLER];
+    timerTicks++;
+    if (timerTicks % TACH_TELEMETRY_TICKS == 0) {
+        TachTelemetry(); // Ultimo valor da media e RPM atual
+    }
+
+    // Com decimacao so segue quando sai um novo valor filtrado
+    if (!AvgPush(raw)) {
+        return;
+    }
+    adcValue = AdcTo12(adcValue16);
+
+    // Sem filtro: o controle usa o valor da media, envia o valor via UART no
+    // modo atual (apenas enfileira) e o estado do cooler fica com os
+    // comparadores (ADC0Seq1IntHandler)
+    if (dspKind == DSP_NONE) {
+        ControlStep(entry, adcValue);
+        StreamSample(adcValue16);
+        return;
+    }
+
+    // Com filtro: a cada bloco a saida filtrada vai para o streaming e
+    // a ultima amostra alimenta o controle e decide o estado
+    if (DspPush(adcValue16)) {
+        for (uint32_t n = 0; n < DSP_BLOCK; n++) {
+            StreamSample(dspOut[n]);
+        }
+        uint32_t filtered = AdcTo12(dspOut[DSP_BLOCK - 1]);
+        ControlStep(entry, filtered);
+        StateTrack(filtered);
+    }
+}
+
+
+// Timer0 apenas gera o gatilho do ADC em hardware (sem interrupcao propria),
+// entao o instante da amostra nao depende da latencia de nenhuma ISR
 void SetupTimer(void) {
     SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER0);
     while(!SysCtlPeripheralReady(SYSCTL_PERIPH_TIMER0));
     TimerConfigure(TIMER0_BASE, TIMER_CFG_PERIODIC);
-    uint32_t timerPeriod = SysClock / 100; 
+    uint32_t timerPeriod = SysClock / ADC_SAMPLE_HZ;
     TimerLoadSet(TIMER0_BASE, TIMER_A, timerPeriod - 1);
-    TimerIntEnable(TIMER0_BASE, TIMER_TIMA_TIMEOUT);
-    TimerIntRegister(TIMER0_BASE, TIMER_A, Timer0IntHandler);
+    TimerControlTrigger(TIMER0_BASE, TIMER_A, true);
     TimerEnable(TIMER0_BASE, TIMER_A);
 }
 
@@ -164,20 +1747,64 @@ void SetupADC(void) {
     while(!SysCtlPeripheralReady(SYSCTL_PERIPH_GPIOE));
     GPIOPinTypeADC(GPIO_PORTE_BASE, GPIO_PIN_4);  // PE4 = AIN9
 
-    ADCSequenceConfigure(ADC0_BASE, ADC_SEQUENCER, ADC_TRIGGER_PROCESSOR, 0);
-    ADCSequenceStepConfigure(ADC0_BASE, ADC_SEQUENCER, 0, ADC_CTL_CH9 | ADC_CTL_IE | ADC_CTL_END);
+    // Um passo por canal; so o ultimo gera interrupcao e encerra a sequencia
+    ADCSequenceConfigure(ADC0_BASE, ADC_SEQUENCER, ADC_TRIGGER_TIMER, 0);
+    for (uint32_t i = 0; i < SCAN_CHANNEL_COUNT; i++) {
+        uint32_t last = (i == SCAN_CHANNEL_COUNT - 1) ? (ADC_CTL_IE | ADC_CTL_END) : 0;
+        ADCSequenceStepConfigure(ADC0_BASE, ADC_SEQUENCER, i, scanChannels[i].adcCtl | last);
+    }
     ADCSequenceEnable(ADC0_BASE, ADC_SEQUENCER);
     ADCIntClear(ADC0_BASE, ADC_SEQUENCER);
+    ADCIntRegister(ADC0_BASE, ADC_SEQUENCER, ADC0Seq0IntHandler);
+    ADCIntEnable(ADC0_BASE, ADC_SEQUENCER);
+
+    // Seq1: AIN9 so para os comparadores (os passos com CMP nao vao para o FIFO)
+    ADCComparatorConfigure(ADC0_BASE, CMP_DOWN, ADC_COMP_TRIG_NONE | ADC_COMP_INT_LOW_ONCE);
+    ADCComparatorConfigure(ADC0_BASE, CMP_UP, ADC_COMP_TRIG_NONE | ADC_COMP_INT_HIGH_ONCE);
+    ADCSequenceConfigure(ADC0_BASE, CMP_SEQUENCER, ADC_TRIGGER_TIMER, 1);
+    ADCSequenceStepConfigure(ADC0_BASE, CMP_SEQUENCER, 0, ADC_CTL_CH9 | ADC_CTL_CMP0);
+    ADCSequenceStepConfigure(ADC0_BASE, CMP_SEQUENCER, 1, ADC_CTL_CH9 | ADC_CTL_CMP1 | ADC_CTL_END);
+    ADCSequenceEnable(ADC0_BASE, CMP_SEQUENCER);
+    ADCComparatorIntClear(ADC0_BASE, ADCComparatorIntStatus(ADC0_BASE));
+    ADCIntRegister(ADC0_BASE, CMP_SEQUENCER, ADC0Seq1IntHandler);
+    ADCComparatorIntEnable(ADC0_BASE, CMP_SEQUENCER);
+    ADCIntEnableEx(ADC0_BASE, ADC_INT_DCON_SS1);
 }
 
 
+// Timer1A em captura de tempo de borda no PD2 (tach do cooler)
+void SetupTach(void) {
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER1);
+    while(!SysCtlPeripheralReady(SYSCTL_PERIPH_TIMER1));
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOD);
+    while(!SysCtlPeripheralReady(SYSCTL_PERIPH_GPIOD));
+    GPIOPinConfigure(GPIO_PD2_T1CCP0);
+    GPIOPinTypeTimer(GPIO_PORTD_BASE, GPIO_PIN_2);
+    GPIOPadConfigSet(GPIO_PORTD_BASE, GPIO_PIN_2, GPIO_STRENGTH_2MA, GPIO_PIN_TYPE_STD_WPU);
+
+    tachRpmNum = 60u * (SysClock / TACH_PULSES_PER_REV);
+    tachMinPeriod = tachRpmNum / TACH_RPM_MAX;
+
+    // Contagem para cima de 0 a 2^24 - 1: o prescaler e a extensao do contador
+    TimerConfigure(TIMER1_BASE, TIMER_CFG_SPLIT_PAIR | TIMER_CFG_A_CAP_TIME_UP);
+    TimerControlEvent(TIMER1_BASE, TIMER_A, TIMER_EVENT_POS_EDGE);
+    TimerLoadSet(TIMER1_BASE, TIMER_A, 0xFFFF);
+    TimerPrescaleSet(TIMER1_BASE, TIMER_A, 0xFF);
+    TimerIntRegister(TIMER1_BASE, TIMER_A, Timer1AIntHandler);
+    TimerIntClear(TIMER1_BASE, TIMER_CAPA_EVENT | TIMER_TIMA_TIMEOUT);
+    TimerIntEnable(TIMER1_BASE, TIMER_CAPA_EVENT | TIMER_TIMA_TIMEOUT);
+    TimerEnable(TIMER1_BASE, TIMER_A);
+}
+
 void SetupUart(void) {
     SysCtlPeripheralEnable(SYSCTL_PERIPH_UART0);
     while(!SysCtlPeripheralReady(SYSCTL_PERIPH_UART0));
-    UARTConfigSetExpClk(UART0_BASE, SysClock, 115200,
+    UARTConfigSetExpClk(UART0_BASE, SysClock, BAUD_DEFAULT,
         (UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE));
-    UARTFIFODisable(UART0_BASE);
-    UARTIntEnable(UART0_BASE, UART_INT_RX);
+    UARTFIFOEnable(UART0_BASE);
+    UARTFIFOLevelSet(UART0_BASE, UART_FIFO_TX2_8, UART_FIFO_RX4_8);
+    UARTTxIntModeSet(UART0_BASE, UART_TXINT_MODE_FIFO);
+    UARTIntEnable(UART0_BASE, UART_INT_RX | UART_INT_RT);
     UARTIntRegister(UART0_BASE, UARTIntHandler);
     SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOA);
     while(!SysCtlPeripheralReady(SYSCTL_PERIPH_GPIOA));
@@ -202,11 +1829,16 @@ void setupPWM(void) {
     PWMClockSet(PWM0_BASE, PWM_SYSCLK_DIV_64);
     uint32_t load = (pwmClock / PWM_FREQUENCY) - 1;
 
-    PWMGenConfigure(PWM0_BASE, PWM_GEN_2, PWM_GEN_MODE_DOWN | PWM_GEN_MODE_NO_SYNC);
+    // Atualizacoes do CMPB so no fim do periodo (ver PwmQueueWidth)
+    PWMGenConfigure(PWM0_BASE, PWM_GEN_2,
+                    PWM_GEN_MODE_DOWN | PWM_GEN_MODE_SYNC | PWM_GEN_MODE_GEN_SYNC_LOCAL);
     PWMGenPeriodSet(PWM0_BASE, PWM_GEN_2, load);
 
     // Duty cycle inicial (0%)
     PWMPulseWidthSet(PWM0_BASE, PWM_OUT_5, 0);
+    PWMSyncUpdate(PWM0_BASE, PWM_GEN_2_BIT);
+    PWMGenIntRegister(PWM0_BASE, PWM_GEN_2, PWMGen2IntHandler);
+    PWMIntEnable(PWM0_BASE, PWM_INT_GEN_2);
 
     // Ativa a saída PWM e o gerador
     PWMOutputState(PWM0_BASE, PWM_OUT_5_BIT, true);
@@ -223,33 +1855,25 @@ void ConfigLEDs(void) {
 
 int main(void) {
     SysClock = SysCtlClockFreqSet((SYSCTL_XTAL_25MHZ | SYSCTL_OSC_MAIN | SYSCTL_USE_PLL | SYSCTL_CFG_VCO_240), 120000000);
+    CycleCounterInit();
     
     SetupUart();
-    SetupTimer();
     SetupADC();
 		setupPWM();	
     ConfigLEDs();
+    CurveRebuild();
+    SetupTach();
+    StateApply(STATE_OFF); // Os comparadores sobem ate o estado certo nas primeiras amostras
+    SetupTimer(); // Por ultimo: as ISRs do ADC ja usam UART, PWM e LEDs
 
     IntMasterEnable();
 
     while (1) {
-        switch (currentState) {
-            case STATE_OFF:
-                ledsOn(LEDS_ON_1);
-                break;
-
-            case STATE_LOW:
-								ledsOn(LEDS_ON_12);
-                break;
-
-            case STATE_MEDIUM:
-								ledsOn(LEDS_ON_123);
-                break;
-
-            case STATE_HIGH:
-								ledsOn(LEDS_ON_ALL);
-                break;
+        if (cmdReady) {
+            ProcessCommand(cmdLine);
+            cmdReady = false;
         }
+        BaudPoll();
 
         __asm(" WFI");
     }
@@ -10,11 +10,35 @@
 #include "driverlib/gpio.h"
 #include "driverlib/uart.h"
 #include "driverlib/adc.h"
+#include "driverlib/timer.h"
 #include "driverlib/pin_map.h"
 #include "driverlib/interrupt.h"
+#include "driverlib/udma.h"
+#include "inc/hw_adc.h"
+#include "dwt.h"
 
 #define ADC_SEQUENCER 3 // Usando o sequenciador 3 do ADC para uma nica amostra
 
+#define ADC_SAMPLE_HZ 1 // Timer0 dispara uma conversao por segundo
+#define ADC_FLAG_SAMPLE 0x0001 // Thread flag: nova amostra em adcValue
+
+// 1 = aquisicao continua (seq0 + uDMA ping-pong) a ACQ_SAMPLE_HZ;
+// 0 = uma amostra por segundo no seq3. O gatilho por timer vale para todos os
+// sequenciadores do ADC, entao os dois modos nao rodam juntos.
+#define ADC_CONTINUOUS 1
+
+#if ADC_CONTINUOUS
+#define ACQ_SAMPLE_HZ   100000 // Taxa da aquisicao continua (ate 2000000)
+#define ACQ_SEQUENCER   0
+#define ACQ_BLOCK_SIZE  512    // Amostras por bloco (ate 1024, limite do uDMA)
+#define ACQ_FLAG_BLOCK0 0x0010 // Thread flags: bloco 0 / bloco 1 pronto
+#define ACQ_FLAG_BLOCK1 0x0020
+#define TRIG_FLAG_READY 0x0040 // Thread flag: captura pronta para envio
+#define ADC_TRIGGER_HZ  ACQ_SAMPLE_HZ
+#else
+#define ADC_TRIGGER_HZ  ADC_SAMPLE_HZ
+#endif
+
 // --- LEDs ---
 #define LED_PORTN GPIO_PORTN_BASE
 #define LED_PORTF GPIO_PORTF_BASE
@@ -24,7 +48,8 @@
 
 // --- Variveis Globais ---
 uint32_t SysClock;
-uint32_t adcValue;
+volatile uint32_t adcValue;
+osThreadId_t adcThread; // Thread avisada a cada conversao
 // --- Configurao dos Perifricos ---
 
 void ConfigLEDs(void) {
@@ -36,6 +61,17 @@ void ConfigLEDs(void) {
     GPIOPinTypeGPIOOutput(LED_PORTF, LED_PIN_4);
 }
 
+// Fim da conversao: guarda a amostra e acorda a thread
+void ADC0Seq3IntHandler(void) {
+    uint32_t sample;
+    ADCIntClear(ADC0_BASE, ADC_SEQUENCER);
+    ADCSequenceDataGet(ADC0_BASE, ADC_SEQUENCER, &sample);
+    adcValue = sample;
+    if (adcThread != NULL) {
+        osThreadFlagsSet(adcThread, ADC_FLAG_SAMPLE);
+    }
+}
+
 void SetupADC(void) {
     SysCtlPeripheralEnable(SYSCTL_PERIPH_ADC0);
     while(!SysCtlPeripheralReady(SYSCTL_PERIPH_ADC0));
@@ -44,22 +80,356 @@ void SetupADC(void) {
     while(!SysCtlPeripheralReady(SYSCTL_PERIPH_GPIOE));
     GPIOPinTypeADC(GPIO_PORTE_BASE, GPIO_PIN_4);  // PE4 = AIN9
 
-    ADCSequenceConfigure(ADC0_BASE, ADC_SEQUENCER, ADC_TRIGGER_PROCESSOR, 0);
+    // Conversao iniciada pelo Timer0 em hardware; o fim chega pela interrupcao
+    ADCSequenceConfigure(ADC0_BASE, ADC_SEQUENCER, ADC_TRIGGER_TIMER, 0);
     ADCSequenceStepConfigure(ADC0_BASE, ADC_SEQUENCER, 0, ADC_CTL_CH9 | ADC_CTL_IE | ADC_CTL_END);
     ADCSequenceEnable(ADC0_BASE, ADC_SEQUENCER);
     ADCIntClear(ADC0_BASE, ADC_SEQUENCER);
+    ADCIntRegister(ADC0_BASE, ADC_SEQUENCER, ADC0Seq3IntHandler);
+    ADCIntEnable(ADC0_BASE, ADC_SEQUENCER);
+}
+
+#if ADC_CONTINUOUS
+// --- Aquisicao continua: seq0 do ADC0 -> uDMA ping-pong -> Thread_Acq ---
+// O Timer0 dispara uma conversao por periodo; cada amostra vai do FIFO do
+// seq0 para um dos dois blocos pelo uDMA. Quando um bloco enche, o uDMA
+// passa para o outro sozinho e a interrupcao do seq0 reprograma o bloco
+// cheio e avisa a thread. A thread tem o tempo de um bloco para processa-lo.
+uint16_t acqBuffer[2][ACQ_BLOCK_SIZE];
+volatile bool acqPending[2];  // Bloco entregue e ainda nao liberado pela thread
+osThreadId_t acqThread;
+
+#if defined(ewarm)
+#pragma data_alignment=1024
+uint8_t dmaControlTable[1024];
+#else
+uint8_t dmaControlTable[1024] __attribute__((aligned(1024)));
+#endif
+
+typedef struct {
+    volatile uint32_t blocks;        // Blocos completos entregues
+    volatile uint32_t overruns;      // Blocos sobrescritos antes de a thread terminar
+    volatile uint32_t fifoOverflows; // FIFO do seq0 estourou (uDMA nao deu conta)
+    uint32_t min;                    // Do ultimo bloco processado
+    uint32_t max;
+    uint32_t mean;
+    uint32_t processCycles;          // Maior tempo de processamento de um bloco (ciclos do DWT)
+} AcqStats;
+
+AcqStats acqStats;
+osThreadId_t acqStatsThread; // Dona da UART: estatisticas e capturas
+
+// Um bloco cheio: reprograma a estrutura (primaria ou alternativa) e avisa a thread
+void ADC0Seq0IntHandler(void) {
+    static const uint32_t select[2] = { UDMA_PRI_SELECT, UDMA_ALT_SELECT };
+
+    ADCIntClearEx(ADC0_BASE, ADC_INT_DMA_SS0);
+    if (ADCSequenceOverflow(ADC0_BASE, ACQ_SEQUENCER)) {
+        ADCSequenceOverflowClear(ADC0_BASE, ACQ_SEQUENCER);
+        acqStats.fifoOverflows++;
+    }
+
+    for (uint32_t i = 0; i < 2; i++) {
+        if (uDMAChannelModeGet(UDMA_CHANNEL_ADC0 | select[i]) != UDMA_MODE_STOP) {
+            continue;
+        }
+        uDMAChannelTransferSet(UDMA_CHANNEL_ADC0 | select[i], UDMA_MODE_PINGPONG,
+                               (void *)(ADC0_BASE + ADC_O_SSFIFO0), acqBuffer[i], ACQ_BLOCK_SIZE);
+        // O uDMA agora escreve no outro bloco: se a thread ainda esta nele, perdemos dados
+        if (acqPending[i ^ 1]) {
+            acqStats.overruns++;
+        }
+        acqPending[i] = true;
+        acqStats.blocks++;
+        osThreadFlagsSet(acqThread, ACQ_FLAG_BLOCK0 << i);
+    }
+
+    // Se as duas estruturas terminaram antes desta ISR o canal parou
+    if (!uDMAChannelIsEnabled(UDMA_CHANNEL_ADC0)) {
+        acqStats.overruns++;
+        uDMAChannelEnable(UDMA_CHANNEL_ADC0);
+    }
+}
+
+void SetupAcquisition(void) {
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_ADC0);
+    while(!SysCtlPeripheralReady(SYSCTL_PERIPH_ADC0));
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOE);
+    while(!SysCtlPeripheralReady(SYSCTL_PERIPH_GPIOE));
+    GPIOPinTypeADC(GPIO_PORTE_BASE, GPIO_PIN_4);  // PE4 = AIN9
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_UDMA);
+    while(!SysCtlPeripheralReady(SYSCTL_PERIPH_UDMA));
+
+    // 480 MHz (VCO) / 15 = 32 MHz de clock do ADC -> ate 2 MSPS
+    ADCClockConfigSet(ADC0_BASE, ADC_CLOCK_SRC_PLL | ADC_CLOCK_RATE_FULL, 15);
+
+    uDMAEnable();
+    uDMAControlBaseSet(dmaControlTable);
+    uDMAChannelAssign(UDMA_CH14_ADC0_0);
+    uDMAChannelAttributeDisable(UDMA_CHANNEL_ADC0, UDMA_ATTR_ALL);
+    uDMAChannelAttributeEnable(UDMA_CHANNEL_ADC0, UDMA_ATTR_HIGH_PRIORITY);
+    uDMAChannelControlSet(UDMA_CHANNEL_ADC0 | UDMA_PRI_SELECT,
+                          UDMA_SIZE_16 | UDMA_SRC_INC_NONE | UDMA_DST_INC_16 | UDMA_ARB_1);
+    uDMAChannelControlSet(UDMA_CHANNEL_ADC0 | UDMA_ALT_SELECT,
+                          UDMA_SIZE_16 | UDMA_SRC_INC_NONE | UDMA_DST_INC_16 | UDMA_ARB_1);
+    uDMAChannelTransferSet(UDMA_CHANNEL_ADC0 | UDMA_PRI_SELECT, UDMA_MODE_PINGPONG,
+                           (void *)(ADC0_BASE + ADC_O_SSFIFO0), acqBuffer[0], ACQ_BLOCK_SIZE);
+    uDMAChannelTransferSet(UDMA_CHANNEL_ADC0 | UDMA_ALT_SELECT, UDMA_MODE_PINGPONG,
+                           (void *)(ADC0_BASE + ADC_O_SSFIFO0), acqBuffer[1], ACQ_BLOCK_SIZE);
+    uDMAChannelEnable(UDMA_CHANNEL_ADC0);
+
+    // Uma amostra por gatilho; o FIFO de 8 posicoes do seq0 absorve a latencia do uDMA
+    ADCSequenceConfigure(ADC0_BASE, ACQ_SEQUENCER, ADC_TRIGGER_TIMER, 0);
+    ADCSequenceStepConfigure(ADC0_BASE, ACQ_SEQUENCER, 0, ADC_CTL_CH9 | ADC_CTL_IE | ADC_CTL_END);
+    ADCSequenceEnable(ADC0_BASE, ACQ_SEQUENCER);
+    ADCSequenceDMAEnable(ADC0_BASE, ACQ_SEQUENCER);
+    ADCIntClearEx(ADC0_BASE, ADC_INT_DMA_SS0);
+    ADCIntRegister(ADC0_BASE, ACQ_SEQUENCER, ADC0Seq0IntHandler);
+    ADCIntEnableEx(ADC0_BASE, ADC_INT_DMA_SS0);
+}
+
+// --- Captura com pre-gatilho (modo osciloscopio) sobre a aquisicao continua ---
+// Toda amostra entra num buffer circular. Com TRIG_PRE_SAMPLES de historico o
+// gatilho fica armado; quando ele dispara, mais TRIG_POST_SAMPLES sao gravadas
+// e o buffer congela ate a Thread_AcqStats enviar a janela pela UART:
+//   "TRIG <n> <modo> <pre> <pos> <Hz> <amostra do gatilho>\r\n",
+//   linhas com 16 amostras e "TRIG END\r\n". Depois o gatilho rearma sozinho.
+// Modos: nivel (amostra >= TRIG_LEVEL), borda de subida/descida em TRIG_LEVEL
+// com TRIG_HYSTERESIS contagens para rearmar, e janela (amostra fora de
+// [TRIG_WINDOW_LOW, TRIG_WINDOW_HIGH]). So a janela capturada vai para o host.
+#define TRIG_RING_SIZE    2048 // Precisa ser potencia de 2
+#define TRIG_PRE_SAMPLES  256
+#define TRIG_POST_SAMPLES 767  // Janela = pre + 1 + pos amostras
+#define TRIG_MODE         TRIG_EDGE_RISING
+#define TRIG_LEVEL        2048
+#define TRIG_HYSTERESIS   32
+#define TRIG_WINDOW_LOW   1024
+#define TRIG_WINDOW_HIGH  3072
+#define TRIG_LINE_SAMPLES 16
+
+#if TRIG_PRE_SAMPLES + 1 + TRIG_POST_SAMPLES > TRIG_RING_SIZE
+#error "Janela de captura maior que o buffer circular"
+#endif
+
+typedef enum {
+    TRIG_LEVEL_ABOVE = 0,
+    TRIG_EDGE_RISING,
+    TRIG_EDGE_FALLING,
+    TRIG_WINDOW_OUT
+} TrigMode;
+
+typedef enum {
+    TRIG_FILLING = 0, // Juntando o historico de pre-gatilho
+    TRIG_ARMED,
+    TRIG_POST,        // Disparou; gravando o pos-gatilho
+    TRIG_READY        // Janela congelada esperando o envio
+} TrigState;
+
+static const char *const trigModeNames[] = { "NIVEL", "SUBIDA", "DESCIDA", "JANELA" };
+
+uint16_t trigRing[TRIG_RING_SIZE];
+uint32_t trigHead = 0;       // Amostras ja gravadas (posicao = trigHead % TRIG_RING_SIZE)
+uint32_t trigFill = 0;
+uint32_t trigRemaining = 0;
+uint32_t trigPosition = 0;   // trigHead da amostra que disparou
+uint32_t trigSampleNumber = 0; // Numero absoluto dessa amostra desde a partida
+uint32_t trigSamples = 0;    // Amostras vistas pelo motor (inclusive com o buffer congelado)
+uint32_t trigCaptures = 0;
+bool trigPrimed = false;     // Borda: o sinal ja passou do lado oposto da histerese
+volatile TrigState trigState = TRIG_FILLING;
+
+static bool TrigFires(uint32_t sample) {
+    switch (TRIG_MODE) {
+        case TRIG_LEVEL_ABOVE:
+            return sample >= TRIG_LEVEL;
+        case TRIG_EDGE_RISING:
+            if (sample + TRIG_HYSTERESIS < TRIG_LEVEL) {
+                trigPrimed = true;
+            } else if (trigPrimed && sample >= TRIG_LEVEL) {
+                return true;
+            }
+            return false;
+        case TRIG_EDGE_FALLING:
+            if (sample >= TRIG_LEVEL + TRIG_HYSTERESIS) {
+                trigPrimed = true;
+            } else if (trigPrimed && sample < TRIG_LEVEL) {
+                return true;
+            }
+            return false;
+        default:
+            return sample < TRIG_WINDOW_LOW || sample > TRIG_WINDOW_HIGH;
+    }
+}
+
+// Roda na Thread_Acq para cada bloco (o buffer do uDMA e copiado para o anel)
+static void TrigProcessBlock(const uint16_t *block) {
+    for (uint32_t i = 0; i < ACQ_BLOCK_SIZE; i++, trigSamples++) {
+        if (trigState == TRIG_READY) {
+            continue; // Janela ainda nao enviada: nada e sobrescrito
+        }
+        uint32_t sample = block[i];
+        trigRing[trigHead++ & (TRIG_RING_SIZE - 1)] = (uint16_t)sample;
+
+        switch (trigState) {
+            case TRIG_FILLING:
+                if (++trigFill >= TRIG_PRE_SAMPLES) {
+                    trigPrimed = false;
+                    trigState = TRIG_ARMED;
+                }
+                break;
+            case TRIG_ARMED:
+                if (TrigFires(sample)) {
+                    trigPosition = trigHead - 1;
+                    trigSampleNumber = trigSamples;
+                    trigRemaining = TRIG_POST_SAMPLES;
+                    trigState = (trigRemaining == 0) ? TRIG_READY : TRIG_POST;
+                }
+                break;
+            case TRIG_POST:
+                if (--trigRemaining == 0) {
+                    trigState = TRIG_READY;
+                }
+                break;
+            default:
+                break;
+        }
+        if (trigState == TRIG_READY) {
+            osThreadFlagsSet(acqStatsThread, TRIG_FLAG_READY);
+        }
+    }
+}
+
+// Estatisticas simples do bloco; a cada ACQ_SAMPLE_HZ amostras (1 s) a media
+// vai para adcValue e a Thread_Led1 e avisada, como no modo de uma amostra
+static void AcqProcessBlock(const uint16_t *block) {
+    static uint32_t samplesSinceLed = 0;
+    uint32_t start = CycleCounterGet();
+    uint32_t min = 0xFFFF;
+    uint32_t max = 0;
+    uint32_t sum = 0;
+
+    for (uint32_t i = 0; i < ACQ_BLOCK_SIZE; i++) {
+        uint32_t sample = block[i];
+        if (sample < min) min = sample;
+        if (sample > max) max = sample;
+        sum += sample;
+    }
+    acqStats.min = min;
+    acqStats.max = max;
+    acqStats.mean = sum / ACQ_BLOCK_SIZE;
+    TrigProcessBlock(block);
+
+    samplesSinceLed += ACQ_BLOCK_SIZE;
+    if (samplesSinceLed >= ACQ_SAMPLE_HZ) {
+        samplesSinceLed -= ACQ_SAMPLE_HZ;
+        adcValue = acqStats.mean;
+        osThreadFlagsSet(adcThread, ADC_FLAG_SAMPLE);
+    }
+
+    uint32_t cycles = CycleCounterGet() - start;
+    if (cycles > acqStats.processCycles) {
+        acqStats.processCycles = cycles;
+    }
+}
+
+void Thread_Acq(void *argument) {
+    while (1) {
+        uint32_t flags = osThreadFlagsWait(ACQ_FLAG_BLOCK0 | ACQ_FLAG_BLOCK1, osFlagsWaitAny, osWaitForever);
+        for (uint32_t i = 0; i < 2; i++) {
+            if (flags & (ACQ_FLAG_BLOCK0 << i)) {
+                AcqProcessBlock(acqBuffer[i]);
+                acqPending[i] = false;
+            }
+        }
+    }
+}
+
+// --- UART0 apenas para as estatisticas (bloqueante, thread de baixa prioridade) ---
+void SetupUart(void) {
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_UART0);
+    while(!SysCtlPeripheralReady(SYSCTL_PERIPH_UART0));
+    UARTConfigSetExpClk(UART0_BASE, SysClock, 115200,
+        (UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE));
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOA);
+    while(!SysCtlPeripheralReady(SYSCTL_PERIPH_GPIOA));
+    GPIOPinConfigure(GPIO_PA0_U0RX);
+    GPIOPinConfigure(GPIO_PA1_U0TX);
+    GPIOPinTypeUART(GPIO_PORTA_BASE, GPIO_PIN_0 | GPIO_PIN_1);
+}
+
+void UARTSend(const char *str) {
+    while (*str) {
+        UARTCharPut(UART0_BASE, *str++);
+    }
+}
+
+// Envia a janela congelada e rearma o gatilho (roda na Thread_AcqStats)
+static void TrigShip(void) {
+    char buffer[TRIG_LINE_SAMPLES * 5 + 3];
+    uint32_t start = trigPosition - TRIG_PRE_SAMPLES;
+    uint32_t total = TRIG_PRE_SAMPLES + 1 + TRIG_POST_SAMPLES;
+
+    snprintf(buffer, sizeof(buffer), "TRIG %u %s %u %u %u %u\r\n",
+             (unsigned)trigCaptures++, trigModeNames[TRIG_MODE], (unsigned)TRIG_PRE_SAMPLES,
+             (unsigned)TRIG_POST_SAMPLES, (unsigned)ACQ_SAMPLE_HZ, (unsigned)trigSampleNumber);
+    UARTSend(buffer);
+    for (uint32_t i = 0; i < total; i += TRIG_LINE_SAMPLES) {
+        uint32_t len = 0;
+        for (uint32_t j = i; j < total && j < i + TRIG_LINE_SAMPLES; j++) {
+            len += snprintf(&buffer[len], sizeof(buffer) - len, (j == i) ? "%u" : " %u",
+                            (unsigned)trigRing[(start + j) & (TRIG_RING_SIZE - 1)]);
+        }
+        snprintf(&buffer[len], sizeof(buffer) - len, "\r\n");
+        UARTSend(buffer);
+    }
+    UARTSend("TRIG END\r\n");
+
+    // A Thread_Acq so volta a gravar quando o estado sai de TRIG_READY
+    trigFill = 0;
+    trigState = TRIG_FILLING;
+}
+
+void Thread_AcqStats(void *argument) {
+    char buffer[128];
+    uint32_t nextStats = osKernelGetTickCount() + 1000;
+    while (1) {
+        int32_t wait = (int32_t)(nextStats - osKernelGetTickCount());
+        uint32_t flags = osThreadFlagsWait(TRIG_FLAG_READY, osFlagsWaitAny, (wait > 0) ? (uint32_t)wait : 0);
+        if (!(flags & osFlagsError) && (flags & TRIG_FLAG_READY) && trigState == TRIG_READY) {
+            TrigShip();
+            continue;
+        }
+        if ((int32_t)(nextStats - osKernelGetTickCount()) > 0) {
+            continue;
+        }
+        nextStats = osKernelGetTickCount() + 1000;
+        snprintf(buffer, sizeof(buffer),
+                 "ACQ %u Hz blocos=%u overruns=%u fifo=%u min=%u max=%u media=%u proc=%u ciclos\r\n",
+                 (unsigned)ACQ_SAMPLE_HZ, (unsigned)acqStats.blocks, (unsigned)acqStats.overruns,
+                 (unsigned)acqStats.fifoOverflows, (unsigned)acqStats.min, (unsigned)acqStats.max,
+                 (unsigned)acqStats.mean, (unsigned)acqStats.processCycles);
+        UARTSend(buffer);
+    }
+}
+#endif
+
+// Timer0 apenas gera o gatilho do ADC (sem interrupcao propria)
+void SetupTimer(void) {
+    SysCtlPeripheralEnable(SYSCTL_PERIPH_TIMER0);
+    while(!SysCtlPeripheralReady(SYSCTL_PERIPH_TIMER0));
+    TimerConfigure(TIMER0_BASE, TIMER_CFG_PERIODIC);
+    TimerLoadSet(TIMER0_BASE, TIMER_A, SysClock / ADC_TRIGGER_HZ - 1);
+    TimerControlTrigger(TIMER0_BASE, TIMER_A, true);
+    TimerEnable(TIMER0_BASE, TIMER_A);
 }
 
 void Thread_Led1(void *argument){
     while(1){
-				ADCProcessorTrigger(ADC0_BASE, ADC_SEQUENCER);
-				while(!ADCIntStatus(ADC0_BASE, ADC_SEQUENCER, false));
-				ADCIntClear(ADC0_BASE, ADC_SEQUENCER);
-				ADCSequenceDataGet(ADC0_BASE, ADC_SEQUENCER, &adcValue);
-        
+        // Bloqueia ate a proxima amostra (uma por segundo, ritmo do Timer0)
+        osThreadFlagsWait(ADC_FLAG_SAMPLE, osFlagsWaitAny, osWaitForever);
+
 			uint8_t current_state = GPIOPinRead(LED_PORTN, LED_PIN_1);
         GPIOPinWrite(LED_PORTN, LED_PIN_1, ~current_state);
-        osDelay(1000); // Espera 1000 ms
     }
 }
 
@@ -88,14 +458,27 @@ int main(void) {
     SysClock = SysCtlClockFreqSet((SYSCTL_XTAL_25MHZ | SYSCTL_OSC_MAIN | SYSCTL_USE_PLL | SYSCTL_CFG_VCO_240), 120000000);
 		SystemCoreClock = SysClock;
     ConfigLEDs();
+#if ADC_CONTINUOUS
+    CycleCounterInit();
+    SetupUart();
+    SetupAcquisition();
+#else
 		SetupADC();
+#endif
     osKernelInitialize();
     osThreadAttr_t ledAttr = { .name = "LED_Thread", .priority = osPriorityNormal };
 
-    osThreadNew(Thread_Led1, NULL, &ledAttr);
+    adcThread = osThreadNew(Thread_Led1, NULL, &ledAttr);
     osThreadNew(Thread_Led2, NULL, &ledAttr);
     osThreadNew(Thread_Led3, NULL, &ledAttr);
+#if ADC_CONTINUOUS
+    osThreadAttr_t acqAttr = { .name = "ACQ_Thread", .priority = osPriorityAboveNormal };
+    osThreadAttr_t statsAttr = { .name = "ACQ_Stats", .priority = osPriorityBelowNormal };
+    acqThread = osThreadNew(Thread_Acq, NULL, &acqAttr);
+    acqStatsThread = osThreadNew(Thread_AcqStats, NULL, &statsAttr);
+#endif
 
+    SetupTimer(); // So comeca a disparar o ADC depois da thread existir
     osKernelStart();
 
     // Loop infinito de segurana
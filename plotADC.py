@@ -1,19 +1,166 @@
 import serial
+import time
 import matplotlib.pyplot as plt
 import matplotlib.animation as animation
 from collections import deque
 
 # --- CONFIGURAÇÕES ---
 PORTA_SERIAL = 'COM8'       # Altere conforme necessário
-BAUDRATE = 115200
+BAUDRATE = 115200            # Taxa de partida do firmware
+BAUDRATE_ALVO = 921600       # Taxa negociada com "BAUD" (None = fica em BAUDRATE)
 TAMANHO_JANELA = 100         # Amostras visíveis
+MODO_BINARIO = False         # True = pede quadros binários (MODE BIN) ao firmware
+MODO_16_BITS = False         # True = texto em escala de 16 bits (MODE ASCII16, lab22)
+USAR_MUX = False             # True = canais CTRL/LOG/DATA multiplexados (MUX ON, lab22)
+CANAIS_ASSINADOS = 0b111     # Bits: 0 CTRL, 1 LOG, 2 DATA (SUB <máscara>)
 
 # --- INICIALIZA SERIAL ---
 ser = serial.Serial(PORTA_SERIAL, BAUDRATE, timeout=0.05)
 
+# --- NEGOCIAÇÃO DO BAUD RATE ---
+# BAUD <taxa> -> ACK <taxa> (taxa antiga); os dois trocam; SYNC -> SYNC OK <taxa>.
+# Sem o SYNC OK o host volta para a taxa antiga (o firmware faz o mesmo sozinho).
+def ler_resposta(prefixos, timeout=1.0):
+    limite = time.time() + timeout
+    while time.time() < limite:
+        linha = ser.readline().decode(errors='ignore').strip().strip('\x00')
+        if linha.startswith(prefixos):
+            return linha
+    return None
+
+def negociar_baud(alvo):
+    anterior = ser.baudrate
+    ser.reset_input_buffer()
+    ser.write(f'BAUD {alvo}\r'.encode())
+    resposta = ler_resposta(('ACK', 'ERR'))
+    if resposta != f'ACK {alvo}':
+        print(f'Firmware recusou {alvo} baud: {resposta}')
+        return False
+    ser.flush()
+    ser.baudrate = alvo
+    time.sleep(0.05)
+    for _ in range(3):
+        ser.reset_input_buffer()
+        ser.write(b'\rSYNC\r')  # O primeiro \r descarta lixo recebido durante a troca
+        if ler_resposta(('SYNC OK',), timeout=0.2) == f'SYNC OK {alvo}':
+            print(f'Link confirmado em {alvo} baud')
+            return True
+    ser.baudrate = anterior
+    print(f'Sem SYNC OK, voltando para {anterior} baud')
+    return False
+
+if BAUDRATE_ALVO and BAUDRATE_ALVO != BAUDRATE:
+    negociar_baud(BAUDRATE_ALVO)
+if MODO_BINARIO:
+    ser.write(b'MODE BIN\r')
+else:
+    ser.write(b'MODE ASCII16\r' if MODO_16_BITS else b'MODE ASCII\r')
+if USAR_MUX:
+    ser.write(f'SUB {CANAIS_ASSINADOS}\r'.encode())
+    ser.write(b'MUX ON\r')
+
 # --- BUFFER DE DADOS ---
 dados = deque([0]*TAMANHO_JANELA, maxlen=TAMANHO_JANELA)
 estado_cooler = "Desconhecido"
+ultimo_log = ""
+recebido = bytearray()       # Bytes ainda sem delimitador 0x00 (modo binário)
+seq_esperada = None
+quadros_perdidos = 0
+quadros_invalidos = 0
+
+# --- DECODIFICAÇÃO DOS QUADROS BINÁRIOS ---
+# Quadro (antes do COBS): seq | n | amostras de 12 bits, 2 a cada 3 bytes | CRC16 (LSB primeiro)
+def cobs_decode(dados):
+    saida = bytearray()
+    i = 0
+    while i < len(dados):
+        codigo = dados[i]
+        if codigo == 0 or i + codigo > len(dados):
+            raise ValueError("COBS invalido")
+        saida += dados[i + 1:i + codigo]
+        i += codigo
+        if codigo < 0xFF and i < len(dados):
+            saida.append(0)
+    return bytes(saida)
+
+def crc16_ccitt(dados):
+    crc = 0xFFFF
+    for byte in dados:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+def decodificar_amostras(quadro):
+    """Recebe o quadro já sem COBS; retorna (seq, amostras) ou None se estiver corrompido."""
+    if len(quadro) < 4:
+        return None
+    seq, n = quadro[0], quadro[1]
+    corpo, crc = quadro[:-2], quadro[-2] | (quadro[-1] << 8)
+    if crc16_ccitt(corpo) != crc or len(corpo) != 2 + (n // 2) * 3:
+        return None
+    amostras = []
+    for i in range(2, len(corpo), 3):
+        b0, b1, b2 = corpo[i], corpo[i + 1], corpo[i + 2]
+        amostras.append(b0 | ((b1 & 0x0F) << 8))
+        amostras.append((b1 >> 4) | (b2 << 4))
+    return seq, amostras
+
+def ler_quadros():
+    """Separa os quadros terminados em 0x00 e retorna a lista já sem COBS."""
+    global recebido, quadros_invalidos
+    recebido += ser.read(ser.in_waiting)
+    quadros = []
+    while b'\x00' in recebido:
+        codificado, _, recebido = recebido.partition(b'\x00')
+        if not codificado:
+            continue
+        try:
+            quadros.append(cobs_decode(bytes(codificado)))
+        except ValueError:
+            quadros_invalidos += 1
+    return quadros
+
+def amostras_do_quadro(quadro):
+    global seq_esperada, quadros_perdidos, quadros_invalidos
+    resultado = decodificar_amostras(quadro)
+    if resultado is None:
+        quadros_invalidos += 1  # Inclui respostas de texto ("OK") aos comandos
+        return []
+    seq, amostras = resultado
+    if seq_esperada is not None and seq != seq_esperada:
+        quadros_perdidos += (seq - seq_esperada) & 0xFF
+    seq_esperada = (seq + 1) & 0xFF
+    return amostras
+
+def ler_binario():
+    valores = []
+    for quadro in ler_quadros():
+        valores += amostras_do_quadro(quadro)
+    return valores
+
+# --- DEMULTIPLEXADOR DE CANAIS (MUX ON) ---
+# Cada quadro é COBS(canal | dados): 0 CTRL (respostas), 1 LOG (texto), 2 DATA (amostras)
+CANAL_CTRL, CANAL_LOG, CANAL_DATA = 0, 1, 2
+
+def ler_mux():
+    global ultimo_log
+    valores = []
+    for quadro in ler_quadros():
+        if not quadro:
+            continue
+        canal, conteudo = quadro[0], quadro[1:]
+        if canal == CANAL_DATA:
+            if MODO_BINARIO:
+                valores += amostras_do_quadro(conteudo)
+            elif conteudo.strip().isdigit():
+                valores.append(int(conteudo))
+        elif canal == CANAL_LOG:
+            ultimo_log = conteudo.decode(errors='ignore').strip()
+        elif canal == CANAL_CTRL:
+            print('CTRL:', conteudo.decode(errors='ignore').strip())
+    return valores
 
 # --- FUNÇÃO PARA DETERMINAR O ESTADO ---
 def determinar_estado(adc):
@@ -29,9 +176,13 @@ def determinar_estado(adc):
 # --- FUNÇÃO DE ATUALIZAÇÃO ---
 def atualizar(frame):
     global dados, estado_cooler
-    while ser.in_waiting:
+    if USAR_MUX or MODO_BINARIO:
+        for valor in (ler_mux() if USAR_MUX else ler_binario()):
+            dados.append(valor)
+            estado_cooler = determinar_estado(valor)
+    while not (USAR_MUX or MODO_BINARIO) and ser.in_waiting:
         try:
-            linha = ser.readline().decode().strip()
+            linha = ser.readline().decode().strip().strip('\x00')
             if linha.isdigit():
                 valor = int(linha)
                 dados.append(valor)
@@ -40,7 +191,12 @@ def atualizar(frame):
             continue
 
     if dados:
-        linha_texto.set_text(f'ADC: {dados[-1]} | Cooler: {estado_cooler}')
+        texto = f'ADC: {dados[-1]} | Cooler: {estado_cooler}'
+        if MODO_BINARIO:
+            texto += f' | Perdidos: {quadros_perdidos}'
+        if ultimo_log:
+            texto += f' | {ultimo_log}'
+        linha_texto.set_text(texto)
         linha_grafico.set_data(range(len(dados)), dados)
 
     return linha_grafico, linha_texto
@@ -50,11 +206,12 @@ fig, ax = plt.subplots()
 linha_grafico, = ax.plot([], [], lw=2)
 linha_texto = ax.text(0.02, 0.95, '', transform=ax.transAxes)
 
-ax.set_ylim(0, 4095)
+ESCALA_MAX = 65520 if MODO_16_BITS and not MODO_BINARIO else 4095
+ax.set_ylim(0, ESCALA_MAX)
 ax.set_xlim(0, TAMANHO_JANELA)
 ax.set_title("Leitura do ADC + Status do COOLER")
 ax.set_xlabel("Amostras")
-ax.set_ylabel("Valor ADC (0–4095)")
+ax.set_ylabel(f"Valor ADC (0–{ESCALA_MAX})")
 ax.grid(True)
 
 # --- ANIMAÇÃO ---